@@ -0,0 +1,344 @@
+// Per-stage parse/serialize benchmark with hardware counters.
+//
+//   libjson_bench [--input FILE | --size BYTES] [--iterations N]
+//                 [--stage NAME] [--format json|csv] [--label TEXT]
+//
+// Stages: tokenise, validate, build, parse (all three), serialize
+// (operator<<) and write (Writer). All per-byte figures are relative to the
+// input document size so stages can be compared with each other. Counter
+// columns are null (JSON) or empty (CSV) when perf events are unavailable.
+
+#include "PerfCounters.h"
+
+#include "io/Sink.h"
+#include "lexer/Lexer.h"
+#include "parser/Parser.h"
+#include "writer/Writer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+struct Config
+{
+    std::string input;
+    size_t size = 4 << 20;
+    size_t iterations = 20;
+    std::string stage;
+    std::string format = "json";
+    std::string label;
+};
+
+struct Result
+{
+    std::string stage;
+    size_t iterations = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+    PerfCounters::Sample counters;
+};
+
+// Deterministic document of roughly `size` bytes with a mix of value types,
+// escapes and non-ASCII text.
+std::string generate(size_t size)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    auto next = [&state]()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    w.begin_object().key("records").begin_array();
+    for (int64_t i = 0; out.size() < size; ++i)
+    {
+        w.begin_object();
+        w.key("id").value(i);
+        w.key("name").value("user_" + std::to_string(next() % 100000));
+        w.key("score").value(static_cast<double>(next() % 1000000) / 1000.0);
+        w.key("active").value(next() % 2 == 0);
+        w.key("tags").begin_array();
+        for (uint64_t t = next() % 5; t > 0; --t)
+            w.value("tag" + std::to_string(t));
+        w.end_array();
+        w.key("address").begin_object().key("city").value("Z\xC3\xBCrich").key("zip").value(next() % 99999).end_object();
+        w.key("note").value(next() % 4 == 0 ? std::string_view("line\n\"quoted\"\tend") : std::string_view());
+        w.key("parent").value(nullptr);
+        w.end_object();
+        w.flush();
+    }
+    w.end_array().end_object();
+    w.finish();
+    return out;
+}
+
+// Runs body `iterations` times with counters and the clock running only
+// around body; setup runs before each iteration, unmeasured.
+Result measure(PerfCounters &counters, const std::string &stage, size_t iterations, size_t bytes,
+               const std::function<void()> &setup, const std::function<void()> &body)
+{
+    using clock = std::chrono::steady_clock;
+    Result r{stage, iterations, bytes, 0, {}};
+    clock::duration elapsed{};
+
+    counters.reset();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        if (setup)
+            setup();
+        auto begin = clock::now();
+        counters.start();
+        body();
+        counters.stop();
+        elapsed += clock::now() - begin;
+    }
+    r.seconds = std::chrono::duration<double>(elapsed).count();
+    r.counters = counters.read();
+    return r;
+}
+
+std::optional<double> perByte(const Result &r, PerfCounters::Event e)
+{
+    if (!r.counters.valid[e] || r.bytes == 0)
+        return std::nullopt;
+    return r.counters.value[e] / static_cast<double>(r.bytes * r.iterations);
+}
+
+std::optional<double> perIteration(const Result &r, PerfCounters::Event e)
+{
+    if (!r.counters.valid[e])
+        return std::nullopt;
+    return r.counters.value[e] / static_cast<double>(r.iterations);
+}
+
+std::optional<double> ipc(const Result &r)
+{
+    if (!r.counters.valid[PerfCounters::CYCLES] || !r.counters.valid[PerfCounters::INSTRUCTIONS] ||
+        r.counters.value[PerfCounters::CYCLES] == 0)
+        return std::nullopt;
+    return r.counters.value[PerfCounters::INSTRUCTIONS] / r.counters.value[PerfCounters::CYCLES];
+}
+
+double throughput(const Result &r)
+{
+    return r.seconds > 0 ? static_cast<double>(r.bytes * r.iterations) / r.seconds / 1e6 : 0;
+}
+
+void emitJson(const Config &config, bool available, const std::vector<Result> &results)
+{
+    OstreamSink sink(std::cout);
+    Writer<OstreamSink> w(sink);
+    auto number = [&w](const std::optional<double> &v) -> Writer<OstreamSink> &
+    {
+        return v ? w.value(*v) : w.value(nullptr);
+    };
+
+    w.begin_object();
+    w.key("label").value(config.label);
+    w.key("counters").value(available);
+    w.key("results").begin_array();
+    for (const Result &r : results)
+    {
+        w.begin_object();
+        w.key("stage").value(r.stage);
+        w.key("iterations").value(r.iterations);
+        w.key("bytes").value(r.bytes);
+        w.key("seconds").value(r.seconds);
+        w.key("mb_per_s").value(throughput(r));
+        w.key("cycles_per_byte");
+        number(perByte(r, PerfCounters::CYCLES));
+        w.key("instructions_per_byte");
+        number(perByte(r, PerfCounters::INSTRUCTIONS));
+        w.key("ipc");
+        number(ipc(r));
+        w.key("branch_misses");
+        number(perIteration(r, PerfCounters::BRANCH_MISSES));
+        w.key("cache_misses");
+        number(perIteration(r, PerfCounters::CACHE_MISSES));
+        w.end_object();
+    }
+    w.end_array().end_object();
+    w.finish();
+    std::cout << '\n';
+}
+
+void emitCsv(const Config &config, const std::vector<Result> &results)
+{
+    auto field = [](const std::optional<double> &v)
+    {
+        return v ? std::to_string(*v) : std::string();
+    };
+
+    std::cout << "label,stage,iterations,bytes,seconds,mb_per_s,cycles_per_byte,instructions_per_byte,ipc,"
+                 "branch_misses,cache_misses\n";
+    for (const Result &r : results)
+    {
+        std::cout << config.label << ',' << r.stage << ',' << r.iterations << ',' << r.bytes << ','
+                  << r.seconds << ',' << throughput(r) << ','
+                  << field(perByte(r, PerfCounters::CYCLES)) << ','
+                  << field(perByte(r, PerfCounters::INSTRUCTIONS)) << ','
+                  << field(ipc(r)) << ','
+                  << field(perIteration(r, PerfCounters::BRANCH_MISSES)) << ','
+                  << field(perIteration(r, PerfCounters::CACHE_MISSES)) << '\n';
+    }
+}
+
+bool parseArgs(int argc, char **argv, Config &config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const char *value = argv[++i];
+        if (arg == "--input")
+            config.input = value;
+        else if (arg == "--size")
+            config.size = std::strtoull(value, nullptr, 10);
+        else if (arg == "--iterations")
+            config.iterations = std::strtoull(value, nullptr, 10);
+        else if (arg == "--stage")
+            config.stage = value;
+        else if (arg == "--format")
+            config.format = value;
+        else if (arg == "--label")
+            config.label = value;
+        else
+            return false;
+    }
+    return config.iterations > 0 && (config.format == "json" || config.format == "csv");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Config config;
+    if (!parseArgs(argc, argv, config))
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " [--input FILE | --size BYTES] [--iterations N] [--stage NAME]"
+                     " [--format json|csv] [--label TEXT]\n";
+        return 2;
+    }
+
+    std::string input;
+    if (!config.input.empty())
+    {
+        std::ifstream in(config.input, std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "cannot read " << config.input << '\n';
+            return 1;
+        }
+        input.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        input = generate(config.size);
+    }
+
+    PerfCounters counters;
+    if (!counters.available())
+        std::cerr << "perf events unavailable, reporting time only\n";
+
+    const size_t bytes = input.size();
+    const size_t n = config.iterations;
+    auto wanted = [&config](std::string_view stage)
+    {
+        return config.stage.empty() || config.stage == stage;
+    };
+
+    Lexer lexer;
+    std::vector<Token> tokens;
+    lexer.reset(input);
+    lexer.tokenise(tokens);
+
+    Parser reference;
+    Json doc = reference.parse(input);
+
+    std::vector<Result> results;
+
+    if (wanted("tokenise"))
+        results.push_back(measure(counters, "tokenise", n, bytes, nullptr, [&]()
+                                  {
+                                      lexer.reset(input);
+                                      lexer.tokenise(tokens);
+                                  }));
+
+    if (wanted("validate"))
+    {
+        Parser validator(tokens);
+        results.push_back(measure(counters, "validate", n, bytes, nullptr, [&]()
+                                  {
+                                      if (!validator.validate())
+                                          std::abort();
+                                  }));
+    }
+
+    if (wanted("build"))
+    {
+        std::optional<Parser> builder;
+        results.push_back(measure(
+            counters, "build", n, bytes, [&]()
+            { builder.emplace(tokens); },
+            [&]()
+            { Json built = builder->takeJson(); }));
+    }
+
+    if (wanted("parse"))
+    {
+        Parser parser;
+        results.push_back(measure(counters, "parse", n, bytes, nullptr, [&]()
+                                  {
+                                      if (!parser.tryParse(input))
+                                          std::abort();
+                                  }));
+    }
+
+    if (wanted("serialize"))
+    {
+        std::ostringstream os;
+        results.push_back(measure(
+            counters, "serialize", n, bytes, [&]()
+            { os.str(std::string()); },
+            [&]()
+            { os << doc; }));
+    }
+
+    if (wanted("write"))
+    {
+        std::string out;
+        results.push_back(measure(
+            counters, "write", n, bytes, [&]()
+            { out.clear(); },
+            [&]()
+            {
+                Writer<StringSink> w{StringSink(out)};
+                w.value(doc);
+                w.finish();
+            }));
+    }
+
+    if (config.format == "csv")
+        emitCsv(config, results);
+    else
+        emitJson(config, counters.available(), results);
+    return 0;
+}
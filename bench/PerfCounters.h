@@ -0,0 +1,158 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define LIBJSON_PERF_EVENTS 1
+#endif
+
+// Hardware counters for the calling thread, opened as one perf_event group
+// so they are enabled and disabled together. Events the kernel or the
+// environment (containers, VMs, perf_event_paranoid) refuses are reported as
+// unavailable; if none can be opened the harness falls back to timing only.
+class PerfCounters
+{
+public:
+    enum Event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        CACHE_MISSES,
+        EVENT_COUNT
+    };
+
+    struct Sample
+    {
+        std::array<bool, EVENT_COUNT> valid{};
+        std::array<double, EVENT_COUNT> value{};
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool available() const { return leader_ >= 0; }
+
+    void reset();
+    void start();
+    void stop();
+    Sample read() const;
+
+    static const char *name(Event e);
+
+private:
+    std::array<int, EVENT_COUNT> fds_;
+    int leader_ = -1;
+};
+
+inline const char *PerfCounters::name(Event e)
+{
+    switch (e)
+    {
+    case CYCLES:
+        return "cycles";
+    case INSTRUCTIONS:
+        return "instructions";
+    case BRANCH_MISSES:
+        return "branch_misses";
+    case CACHE_MISSES:
+        return "cache_misses";
+    default:
+        return "unknown";
+    }
+}
+
+#ifdef LIBJSON_PERF_EVENTS
+
+inline PerfCounters::PerfCounters()
+{
+    static constexpr uint64_t configs[EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_MISSES,
+    };
+
+    fds_.fill(-1);
+    for (int e = 0; e < EVENT_COUNT; ++e)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.disabled = leader_ < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+        fds_[e] = fd;
+        if (fd >= 0 && leader_ < 0)
+            leader_ = fd;
+    }
+}
+
+inline PerfCounters::~PerfCounters()
+{
+    for (int fd : fds_)
+        if (fd >= 0)
+            ::close(fd);
+}
+
+inline void PerfCounters::reset()
+{
+    if (leader_ >= 0)
+        ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+}
+
+inline void PerfCounters::start()
+{
+    if (leader_ >= 0)
+        ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+inline void PerfCounters::stop()
+{
+    if (leader_ >= 0)
+        ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Values are scaled by enabled/running time in case the kernel multiplexed
+// the group with other users of the PMU.
+inline PerfCounters::Sample PerfCounters::read() const
+{
+    Sample s;
+    for (int e = 0; e < EVENT_COUNT; ++e)
+    {
+        uint64_t data[3];
+        if (fds_[e] < 0 || ::read(fds_[e], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            continue;
+        s.valid[e] = true;
+        s.value[e] = static_cast<double>(data[0]) * (static_cast<double>(data[1]) / static_cast<double>(data[2]));
+    }
+    return s;
+}
+
+#else
+
+inline PerfCounters::PerfCounters() { fds_.fill(-1); }
+inline PerfCounters::~PerfCounters() = default;
+inline void PerfCounters::reset() {}
+inline void PerfCounters::start() {}
+inline void PerfCounters::stop() {}
+inline PerfCounters::Sample PerfCounters::read() const { return {}; }
+
+#endif
+
+#endif // PERFCOUNTERS_H
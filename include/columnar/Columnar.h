@@ -0,0 +1,707 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include "json/Config.h"
+#include "json/JsonKey.h"
+#include "lexer/CharClass.h"
+#include "lexer/Lexer.h"
+#include "lexer/Utf8.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Column names and types for ColumnarConverter, in output order.
+class ColumnSchema
+{
+public:
+    enum Type
+    {
+        INTEGER,
+        FLOAT,
+        BOOLEAN,
+        // Strings as is; numbers, booleans and nested values as their JSON text.
+        STRING
+    };
+
+    struct Field
+    {
+        std::string name;
+        Type type;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    ColumnSchema() = default;
+    ColumnSchema(std::initializer_list<Field> fields)
+    {
+        for (const auto &f : fields)
+            add(f.name, f.type);
+    }
+
+    ColumnSchema &add(std::string name, Type type);
+
+    const std::vector<Field> &fields() const { return fields_; }
+    size_t size() const { return fields_.size(); }
+
+    // Column of a top-level key, or npos.
+    size_t index(const JsonKey &key) const
+    {
+        auto it = index_.find(key);
+        return it == index_.end() ? npos : it->second;
+    }
+
+private:
+    std::vector<Field> fields_;
+    std::unordered_map<std::string, size_t, JsonKeyHash, std::equal_to<>> index_;
+};
+
+inline ColumnSchema &ColumnSchema::add(std::string name, Type type)
+{
+    if (!index_.try_emplace(name, fields_.size()).second)
+        LIBJSON_THROW(std::invalid_argument("Duplicate column: " + name));
+    fields_.push_back({std::move(name), type});
+    return *this;
+}
+
+// One column of a batch. Only the buffer for the column's type is filled:
+// integers, floats or booleans hold one entry per row, strings are the
+// bytes between offsets[row] and offsets[row + 1]. Bit row % 64 of
+// validity[row / 64] is set when the row has a value; missing and null
+// fields hold 0 or an empty string. The buffers are plain vectors so a
+// finished column can be moved out without copying.
+struct Column
+{
+    std::string name;
+    ColumnSchema::Type type = ColumnSchema::STRING;
+    size_t rows = 0;
+    std::vector<uint64_t> validity;
+    std::vector<int64_t> integers;
+    std::vector<double> floats;
+    std::vector<uint8_t> booleans;
+    std::vector<uint64_t> offsets;
+    std::string bytes;
+
+    bool valid(size_t row) const { return validity[row / 64] >> (row % 64) & 1; }
+
+    std::string_view string(size_t row) const
+    {
+        return std::string_view(bytes).substr(offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+    size_t null_count() const
+    {
+        size_t set = 0;
+        for (uint64_t w : validity)
+            set += static_cast<size_t>(std::popcount(w));
+        return rows - set;
+    }
+};
+
+struct ColumnBatch
+{
+    // Line number of the batch's first line in the whole input.
+    size_t firstLine = 1;
+    size_t rows = 0;
+    std::vector<Column> columns;
+};
+
+// Converts NDJSON (one object per line) into struct-of-arrays batches.
+// Top-level fields named in the schema are parsed straight into their
+// columns; other fields are skipped without being decoded, and no Json is
+// built. Batches of batchRows lines are converted in parallel and returned
+// in input order. Blank lines are ignored. A malformed line, or a value
+// its column cannot hold, throws std::runtime_error naming the line. When
+// a key repeats within a record the last value wins.
+class ColumnarConverter
+{
+public:
+    static constexpr size_t default_batch_rows = 64 * 1024;
+
+    explicit ColumnarConverter(ColumnSchema schema, size_t threads = 0, size_t batchRows = default_batch_rows)
+        : schema_(std::move(schema)),
+          threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          batchRows_(std::max<size_t>(batchRows, 1)) {}
+
+    const ColumnSchema &schema() const { return schema_; }
+
+    std::vector<ColumnBatch> convert(std::string_view ndjson) const;
+
+    // Converts all of lines on the calling thread.
+    ColumnBatch convertBatch(std::string_view lines, size_t firstLine = 1) const;
+
+    // Schema of the scalar top-level fields in the first maxLines lines, in
+    // order of first appearance. Integers mixed with floats become FLOAT;
+    // any other mix, nested values and fields that are only null become
+    // STRING.
+    static ColumnSchema infer(std::string_view ndjson, size_t maxLines = 1000);
+
+private:
+    ColumnSchema schema_;
+    size_t threads_;
+    size_t batchRows_;
+
+    struct Scalar
+    {
+        enum Kind
+        {
+            NUL,
+            BOOLEAN,
+            INTEGER,
+            FLOAT,
+            STRING,
+            NESTED
+        };
+
+        Kind kind = NUL;
+        bool boolean = false;
+        int64_t integer = 0;
+        double real = 0;
+        // Decoded string, or the source text of numbers and nested values.
+        std::string_view text;
+    };
+
+    // Walks the top-level fields of one record.
+    class Scanner
+    {
+    public:
+        template <typename Select, typename Store>
+        bool record(std::string_view line, Select &&select, Store &&store);
+
+        const char *error() const { return error_; }
+
+    private:
+        Lexer lexer_;
+        Token token_{Token::EOFTOKEN};
+        const char *error_ = "";
+
+        bool fail(const char *reason)
+        {
+            error_ = reason;
+            return false;
+        }
+        bool string(const char *p, size_t &i, size_t n, std::string_view &out);
+        bool value(const char *p, size_t &i, size_t n, Scalar &out);
+        static size_t skipString(const char *p, size_t i, size_t n);
+        static size_t skipValue(const char *p, size_t i, size_t n);
+    };
+
+    template <typename Fn>
+    static void lines(std::string_view text, size_t firstLine, size_t maxLines, Fn &&fn);
+    [[noreturn]] static void error(size_t line, const std::string &reason);
+
+    static void append(Column &column, const Scalar &value, size_t line);
+    static void appendNull(Column &column);
+    static void removeLast(Column &column);
+    static void pushValid(Column &column, bool valid);
+};
+
+[[noreturn]] inline void ColumnarConverter::error(size_t line, const std::string &reason)
+{
+    LIBJSON_THROW(std::runtime_error("Invalid NDJSON at line " + std::to_string(line) + ": " + reason));
+}
+
+// Calls fn(line, number) for up to maxLines non-blank lines, without the
+// line terminator.
+template <typename Fn>
+void ColumnarConverter::lines(std::string_view text, size_t firstLine, size_t maxLines, Fn &&fn)
+{
+    size_t number = firstLine;
+    size_t seen = 0;
+    for (size_t i = 0; i < text.size() && seen < maxLines; ++number)
+    {
+        const void *nl = std::memchr(text.data() + i, '\n', text.size() - i);
+        size_t end = nl ? static_cast<size_t>(static_cast<const char *>(nl) - text.data()) : text.size();
+        std::string_view line = text.substr(i, end - i);
+        i = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (CharClass::skipWhitespace(line.data(), 0, line.size()) == line.size())
+            continue;
+        fn(line, number);
+        ++seen;
+    }
+}
+
+inline std::vector<ColumnBatch> ColumnarConverter::convert(std::string_view ndjson) const
+{
+    std::vector<std::pair<std::string_view, size_t>> ranges;
+    size_t begin = 0;
+    size_t line = 1;
+    size_t count = 0;
+    for (size_t i = 0; i < ndjson.size();)
+    {
+        const void *nl = std::memchr(ndjson.data() + i, '\n', ndjson.size() - i);
+        i = nl ? static_cast<size_t>(static_cast<const char *>(nl) - ndjson.data()) + 1 : ndjson.size();
+        if (++count == batchRows_ || i == ndjson.size())
+        {
+            ranges.emplace_back(ndjson.substr(begin, i - begin), line);
+            line += count;
+            begin = i;
+            count = 0;
+        }
+    }
+
+    std::vector<ColumnBatch> batches(ranges.size());
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr failure;
+
+    auto worker = [&]()
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < ranges.size();)
+        {
+            if (failed.load(std::memory_order_relaxed))
+                return;
+            LIBJSON_TRY
+            {
+                batches[i] = convertBatch(ranges[i].first, ranges[i].second);
+            }
+            LIBJSON_CATCH(...)
+            {
+                if (!failed.exchange(true))
+                    failure = std::current_exception();
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::min(threads_, ranges.size()); ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    if (failure)
+        std::rethrow_exception(failure);
+    return batches;
+}
+
+inline ColumnBatch ColumnarConverter::convertBatch(std::string_view text, size_t firstLine) const
+{
+    ColumnBatch batch;
+    batch.firstLine = firstLine;
+    batch.columns.resize(schema_.size());
+    for (size_t c = 0; c < schema_.size(); ++c)
+    {
+        batch.columns[c].name = schema_.fields()[c].name;
+        batch.columns[c].type = schema_.fields()[c].type;
+        if (batch.columns[c].type == ColumnSchema::STRING)
+            batch.columns[c].offsets.push_back(0);
+    }
+
+    Scanner scanner;
+    // Row each column last received a value in.
+    std::vector<size_t> filled(schema_.size(), ColumnSchema::npos);
+    auto select = [this](std::string_view key)
+    {
+        return schema_.index(key);
+    };
+
+    lines(text, firstLine, static_cast<size_t>(-1), [&](std::string_view line, size_t number)
+          {
+              const size_t row = batch.rows;
+              auto store = [&](size_t c, const Scalar &v)
+              {
+                  if (filled[c] == row)
+                      removeLast(batch.columns[c]);
+                  append(batch.columns[c], v, number);
+                  filled[c] = row;
+              };
+              if (!scanner.record(line, select, store))
+                  error(number, scanner.error());
+              for (size_t c = 0; c < filled.size(); ++c)
+                  if (filled[c] != row)
+                      appendNull(batch.columns[c]);
+              ++batch.rows;
+          });
+    return batch;
+}
+
+inline ColumnSchema ColumnarConverter::infer(std::string_view ndjson, size_t maxLines)
+{
+    constexpr int unknown = -1;
+    std::vector<std::string> names;
+    std::vector<int> types;
+    std::unordered_map<std::string, size_t, JsonKeyHash, std::equal_to<>> index;
+
+    auto merge = [](int current, ColumnSchema::Type seen)
+    {
+        if (current == unknown || current == seen)
+            return static_cast<int>(seen);
+        if ((current == ColumnSchema::INTEGER && seen == ColumnSchema::FLOAT) ||
+            (current == ColumnSchema::FLOAT && seen == ColumnSchema::INTEGER))
+            return static_cast<int>(ColumnSchema::FLOAT);
+        return static_cast<int>(ColumnSchema::STRING);
+    };
+
+    auto select = [&](std::string_view key)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            it = index.try_emplace(std::string(key), names.size()).first;
+            names.emplace_back(key);
+            types.push_back(unknown);
+        }
+        return it->second;
+    };
+    auto store = [&](size_t c, const Scalar &v)
+    {
+        // Indexed by Scalar::Kind.
+        static constexpr ColumnSchema::Type kinds[] = {ColumnSchema::STRING, ColumnSchema::BOOLEAN,
+                                                       ColumnSchema::INTEGER, ColumnSchema::FLOAT,
+                                                       ColumnSchema::STRING, ColumnSchema::STRING};
+        if (v.kind != Scalar::NUL)
+            types[c] = merge(types[c], kinds[v.kind]);
+    };
+
+    Scanner scanner;
+    lines(ndjson, 1, maxLines, [&](std::string_view line, size_t number)
+          {
+              if (!scanner.record(line, select, store))
+                  error(number, scanner.error());
+          });
+
+    ColumnSchema schema;
+    for (size_t c = 0; c < names.size(); ++c)
+        schema.add(std::move(names[c]), types[c] == unknown ? ColumnSchema::STRING : static_cast<ColumnSchema::Type>(types[c]));
+    return schema;
+}
+
+inline void ColumnarConverter::pushValid(Column &column, bool valid)
+{
+    if (column.rows % 64 == 0)
+        column.validity.push_back(0);
+    if (valid)
+        column.validity.back() |= uint64_t(1) << (column.rows % 64);
+    ++column.rows;
+}
+
+inline void ColumnarConverter::appendNull(Column &column)
+{
+    switch (column.type)
+    {
+    case ColumnSchema::INTEGER:
+        column.integers.push_back(0);
+        break;
+    case ColumnSchema::FLOAT:
+        column.floats.push_back(0);
+        break;
+    case ColumnSchema::BOOLEAN:
+        column.booleans.push_back(0);
+        break;
+    case ColumnSchema::STRING:
+        column.offsets.push_back(column.bytes.size());
+        break;
+    }
+    pushValid(column, false);
+}
+
+inline void ColumnarConverter::append(Column &column, const Scalar &v, size_t line)
+{
+    if (v.kind == Scalar::NUL)
+        return appendNull(column);
+
+    bool ok = true;
+    switch (column.type)
+    {
+    case ColumnSchema::INTEGER:
+        ok = v.kind == Scalar::INTEGER;
+        if (ok)
+            column.integers.push_back(v.integer);
+        break;
+    case ColumnSchema::FLOAT:
+        ok = v.kind == Scalar::INTEGER || v.kind == Scalar::FLOAT;
+        if (ok)
+            column.floats.push_back(v.kind == Scalar::INTEGER ? static_cast<double>(v.integer) : v.real);
+        break;
+    case ColumnSchema::BOOLEAN:
+        ok = v.kind == Scalar::BOOLEAN;
+        if (ok)
+            column.booleans.push_back(v.boolean);
+        break;
+    case ColumnSchema::STRING:
+        column.bytes.append(v.kind == Scalar::BOOLEAN ? (v.boolean ? "true" : "false") : v.text);
+        column.offsets.push_back(column.bytes.size());
+        break;
+    }
+    if (!ok)
+        error(line, "value does not fit column '" + column.name + "'");
+    pushValid(column, true);
+}
+
+inline void ColumnarConverter::removeLast(Column &column)
+{
+    --column.rows;
+    column.validity.back() &= ~(uint64_t(1) << (column.rows % 64));
+    if (column.rows % 64 == 0)
+        column.validity.pop_back();
+
+    switch (column.type)
+    {
+    case ColumnSchema::INTEGER:
+        column.integers.pop_back();
+        break;
+    case ColumnSchema::FLOAT:
+        column.floats.pop_back();
+        break;
+    case ColumnSchema::BOOLEAN:
+        column.booleans.pop_back();
+        break;
+    case ColumnSchema::STRING:
+        column.offsets.pop_back();
+        column.bytes.resize(column.offsets.back());
+        break;
+    }
+}
+
+// select(key) returns the column for a key or npos to skip its value;
+// store(column, value) receives the parsed value.
+template <typename Select, typename Store>
+bool ColumnarConverter::Scanner::record(std::string_view line, Select &&select, Store &&store)
+{
+    const char *p = line.data();
+    const size_t n = line.size();
+    auto ws = [p, n](size_t i)
+    { return CharClass::skipWhitespace(p, i, n); };
+
+    size_t i = ws(0);
+    if (i == n || p[i] != '{')
+        return fail("expected an object");
+    i = ws(i + 1);
+    if (i < n && p[i] == '}')
+    {
+        ++i;
+    }
+    else
+    {
+        for (;;)
+        {
+            std::string_view key;
+            if (!string(p, i, n, key))
+                return fail("expected a key");
+            size_t column = select(key);
+            i = ws(i);
+            if (i == n || p[i] != ':')
+                return fail("expected ':'");
+            i = ws(i + 1);
+
+            if (column == ColumnSchema::npos)
+            {
+                i = skipValue(p, i, n);
+                if (i == ColumnSchema::npos)
+                    return fail("malformed value");
+            }
+            else
+            {
+                Scalar v;
+                if (!value(p, i, n, v))
+                    return fail("malformed value");
+                store(column, v);
+            }
+
+            i = ws(i);
+            if (i < n && p[i] == ',')
+            {
+                i = ws(i + 1);
+                continue;
+            }
+            if (i < n && p[i] == '}')
+            {
+                ++i;
+                break;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+    if (ws(i) != n)
+        return fail("unexpected characters after the object");
+    return true;
+}
+
+// Strings without escapes are returned as views into the line; escaped ones
+// are decoded by the lexer into token_.
+inline bool ColumnarConverter::Scanner::string(const char *p, size_t &i, size_t n, std::string_view &out)
+{
+    if (i >= n || p[i] != '"')
+        return false;
+    size_t start = i + 1;
+    bool ascii = true;
+    size_t end = Utf8::findSpecial(p, start, n, ascii);
+    if (end < n && p[end] == '"')
+    {
+        if (!ascii && !Utf8::validate(p + start, end - start))
+            return false;
+        out = std::string_view(p + start, end - start);
+        i = end + 1;
+        return true;
+    }
+
+    end = skipString(p, i, n);
+    if (end == ColumnSchema::npos)
+        return false;
+    lexer_.reset(std::string_view(p + i, end - i));
+    lexer_.nextToken(token_);
+    if (token_.type != Token::STRING)
+        return false;
+    out = token_.lexeme;
+    i = end;
+    return true;
+}
+
+inline bool ColumnarConverter::Scanner::value(const char *p, size_t &i, size_t n, Scalar &out)
+{
+    if (i >= n)
+        return false;
+
+    const char c = p[i];
+    if (c == '"')
+    {
+        out.kind = Scalar::STRING;
+        return string(p, i, n, out.text);
+    }
+    if (c == '{' || c == '[')
+    {
+        size_t end = skipValue(p, i, n);
+        if (end == ColumnSchema::npos)
+            return false;
+        out.kind = Scalar::NESTED;
+        out.text = std::string_view(p + i, end - i);
+        i = end;
+        return true;
+    }
+    if (c == 't' || c == 'f' || c == 'n')
+    {
+        size_t len = 0;
+        if (n - i >= 4 && CharClass::equals4(p + i, "true"))
+        {
+            out.kind = Scalar::BOOLEAN;
+            out.boolean = true;
+            len = 4;
+        }
+        else if (c == 'f' && n - i >= 5 && CharClass::equals4(p + i + 1, "alse"))
+        {
+            out.kind = Scalar::BOOLEAN;
+            len = 5;
+        }
+        else if (n - i >= 4 && CharClass::equals4(p + i, "null"))
+        {
+            out.kind = Scalar::NUL;
+            len = 4;
+        }
+        if (len == 0 || (i + len < n && CharClass::is(p[i + len], CharClass::ALPHA)))
+            return false;
+        i += len;
+        return true;
+    }
+
+    // Numbers follow the lexer's grammar.
+    const size_t start = i;
+    if (p[i] == '-')
+        ++i;
+    size_t digits = i;
+    i = CharClass::skipDigits(p, i, n);
+    if (i == digits)
+        return false;
+    bool isFloat = false;
+    if (i < n && p[i] == '.')
+    {
+        isFloat = true;
+        digits = ++i;
+        i = CharClass::skipDigits(p, i, n);
+        if (i == digits)
+            return false;
+    }
+    if (i < n && (p[i] == 'e' || p[i] == 'E'))
+    {
+        isFloat = true;
+        ++i;
+        if (i < n && (p[i] == '+' || p[i] == '-'))
+            ++i;
+        digits = i;
+        i = CharClass::skipDigits(p, i, n);
+        if (i == digits)
+            return false;
+    }
+
+    out.text = std::string_view(p + start, i - start);
+    if (!isFloat && std::from_chars(p + start, p + i, out.integer).ec == std::errc())
+    {
+        out.kind = Scalar::INTEGER;
+        return true;
+    }
+    // Integers beyond int64 are kept as floats.
+    out.kind = Scalar::FLOAT;
+    return std::from_chars(p + start, p + i, out.real).ec == std::errc();
+}
+
+// Index just past the string starting at p[i], or npos if unterminated.
+inline size_t ColumnarConverter::Scanner::skipString(const char *p, size_t i, size_t n)
+{
+    bool ascii = true;
+    for (++i;;)
+    {
+        i = Utf8::findSpecial(p, i, n, ascii);
+        if (i >= n)
+            return ColumnSchema::npos;
+        if (p[i] == '"')
+            return i + 1;
+        if (p[i] != '\\')
+            return ColumnSchema::npos;
+        i += 2;
+    }
+}
+
+// Index just past the value starting at p[i], or npos. Nested values are
+// only checked for balanced brackets and terminated strings.
+inline size_t ColumnarConverter::Scanner::skipValue(const char *p, size_t i, size_t n)
+{
+    if (i >= n)
+        return ColumnSchema::npos;
+    if (p[i] == '"')
+        return skipString(p, i, n);
+
+    if (p[i] == '{' || p[i] == '[')
+    {
+        size_t depth = 0;
+        while (i < n)
+        {
+            char c = p[i];
+            if (c == '"')
+            {
+                i = skipString(p, i, n);
+                if (i == ColumnSchema::npos)
+                    return i;
+                continue;
+            }
+            if (c == '{' || c == '[')
+                ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0)
+                return i + 1;
+            ++i;
+        }
+        return ColumnSchema::npos;
+    }
+
+    size_t start = i;
+    while (i < n && CharClass::is(p[i], CharClass::NUMBER | CharClass::ALPHA))
+        ++i;
+    return i == start ? ColumnSchema::npos : i;
+}
+
+#endif // COLUMNAR_H
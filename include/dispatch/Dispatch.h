@@ -0,0 +1,49 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <atomic>
+#include <cstddef>
+
+// Runtime kernel selection for the compiled library (BUILD_LIBRARY). The
+// library builds the SIMD kernels once per instruction set and picks the
+// best one the host supports when it is loaded, so a binary built for
+// baseline x86-64 still runs AVX2/AVX-512 code where available. Linking
+// libjson_compiled defines LIBJSON_DISPATCH, which routes Utf8::validate and
+// Utf8::findSpecial through the selected kernels; header-only builds keep
+// using whatever -march they are compiled with.
+class Dispatch
+{
+public:
+    enum Isa
+    {
+        BASELINE,
+        SSE42,
+        AVX2,
+        AVX512
+    };
+
+    struct Kernels
+    {
+        Isa isa;
+        bool (*validateUtf8)(const char *p, size_t n);
+        size_t (*findSpecial)(const char *p, size_t i, size_t n, bool &ascii);
+    };
+
+    static const Kernels &kernels() { return *active_.load(std::memory_order_relaxed); }
+    static Isa isa() { return kernels().isa; }
+    static const char *name(Isa isa);
+
+    // Best instruction set that is both built into the library and
+    // supported by this CPU and OS.
+    static Isa detect();
+    static bool supported(Isa isa);
+
+    // Switches kernels, e.g. to compare variants; returns false and keeps
+    // the current ones if isa is unsupported here.
+    static bool select(Isa isa);
+
+private:
+    static std::atomic<const Kernels *> active_;
+};
+
+#endif // DISPATCH_H
@@ -0,0 +1,432 @@
+#ifndef ELEMENTINDEX_H
+#define ELEMENTINDEX_H
+
+#include "json/Config.h"
+#include "json/JsonKey.h"
+#include "lexer/CharClass.h"
+#include "lexer/Lexer.h"
+#include "lexer/Utf8.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Byte ranges of the elements of a top-level array or the records of an
+// NDJSON file, so element N can be read and parsed without scanning what
+// precedes it. Each element may carry a 64-bit fingerprint of its top-level
+// object keys for cheap filtering by key.
+//
+// Sidecar layout (native endianness):
+//
+//   header : "LJIX" | u32 version | u32 flags | u32 reserved | u64 count | u64 source size
+//   body   : u64 offsets[count] | u64 lengths[count] | u64 fingerprints[count] (flag 1)
+class ElementIndex
+{
+public:
+    static constexpr char magic[4] = {'L', 'J', 'I', 'X'};
+    static constexpr uint32_t version = 1;
+    static constexpr size_t header_size = 32;
+
+    size_t size() const { return offsets_.size(); }
+    bool hasFingerprints() const { return fingerprinted_; }
+    // Size of the indexed input; a file of another size is not the one indexed.
+    uint64_t sourceSize() const { return sourceSize_; }
+
+    uint64_t offset(size_t i) const { return offsets_[i]; }
+    uint64_t length(size_t i) const { return lengths_[i]; }
+
+    std::string_view element(std::string_view source, size_t i) const
+    {
+        return source.substr(offsets_[i], lengths_[i]);
+    }
+
+    // Elements [first, first + count) with one seek and one read; throws
+    // std::out_of_range for a bad range and std::runtime_error on a short read.
+    std::vector<std::string> read(std::istream &in, size_t first, size_t count = 1) const;
+
+    // False only if element i is certainly not an object with this key.
+    bool mayContain(size_t i, const JsonKey &key) const
+    {
+        if (!fingerprinted_)
+            return true;
+        uint64_t f = fingerprint(key);
+        return (fingerprints_[i] & f) == f;
+    }
+
+    static uint64_t fingerprint(const JsonKey &key)
+    {
+        uint64_t h = key.hash();
+        return (uint64_t(1) << (h & 63)) | (uint64_t(1) << ((h >> 6) & 63));
+    }
+
+    std::string serialize() const;
+    static ElementIndex deserialize(std::string_view data);
+
+    void save(const std::string &path) const;
+    static ElementIndex load(const std::string &path);
+
+private:
+    friend class ElementIndexBuilder;
+
+    std::vector<uint64_t> offsets_;
+    std::vector<uint64_t> lengths_;
+    std::vector<uint64_t> fingerprints_;
+    uint64_t sourceSize_ = 0;
+    bool fingerprinted_ = false;
+};
+
+// Builds an ElementIndex in one pass over input fed in arbitrary chunks.
+// Only string boundaries and bracket nesting are tracked, so the input is
+// not validated; parse the elements read back to check them. NDJSON records
+// may span lines as long as a record's brackets are still open at the line
+// break.
+class ElementIndexBuilder
+{
+public:
+    enum Format
+    {
+        ARRAY,
+        NDJSON
+    };
+
+    static constexpr size_t chunk_size = 1 << 20;
+
+    explicit ElementIndexBuilder(Format format, bool fingerprints = false)
+        : format_(format), fingerprints_(fingerprints), base_(format == ARRAY ? 1 : 0) {}
+
+    void feed(std::string_view chunk);
+    void feed(std::istream &in);
+    // Throws std::runtime_error if the input ended inside an element.
+    ElementIndex finish();
+
+    // Builds the index of a whole file.
+    static ElementIndex build(const std::string &path, Format format, bool fingerprints = false);
+
+private:
+    Format format_;
+    bool fingerprints_;
+    size_t base_;
+    ElementIndex index_;
+
+    uint64_t offset_ = 0;
+    size_t depth_ = 0;
+    bool inString_ = false;
+    bool escape_ = false;
+    bool rootClosed_ = false;
+
+    // The element being scanned; last_ is one past its last non-whitespace byte.
+    bool open_ = false;
+    bool container_ = false;
+    bool object_ = false;
+    uint64_t start_ = 0;
+    uint64_t last_ = 0;
+    uint64_t fingerprint_ = 0;
+
+    bool expectKey_ = false;
+    bool inKey_ = false;
+    std::string key_;
+    Lexer lexer_;
+    Token token_{Token::EOFTOKEN};
+
+    void begin(uint64_t pos, char c);
+    void end();
+    void keyDone();
+    [[noreturn]] static void error(uint64_t pos, const char *what);
+};
+
+inline std::vector<std::string> ElementIndex::read(std::istream &in, size_t first, size_t count) const
+{
+    if (count == 0 || first >= size() || count > size() - first)
+        LIBJSON_THROW(std::out_of_range("Element range out of bounds"));
+
+    const size_t last = first + count - 1;
+    const uint64_t begin = offsets_[first];
+    std::string span(offsets_[last] + lengths_[last] - begin, '\0');
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(begin));
+    if (!in.read(span.data(), static_cast<std::streamsize>(span.size())))
+        LIBJSON_THROW(std::runtime_error("Failed to read indexed elements"));
+
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (size_t i = first; i <= last; ++i)
+        out.emplace_back(span, offsets_[i] - begin, lengths_[i]);
+    return out;
+}
+
+inline std::string ElementIndex::serialize() const
+{
+    auto put = [](std::string &out, auto v)
+    {
+        out.append(reinterpret_cast<const char *>(&v), sizeof(v));
+    };
+    auto putAll = [](std::string &out, const std::vector<uint64_t> &values)
+    {
+        out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(uint64_t));
+    };
+
+    std::string out(magic, sizeof(magic));
+    put(out, version);
+    put(out, static_cast<uint32_t>(fingerprinted_ ? 1 : 0));
+    put(out, uint32_t(0));
+    put(out, static_cast<uint64_t>(offsets_.size()));
+    put(out, sourceSize_);
+    putAll(out, offsets_);
+    putAll(out, lengths_);
+    putAll(out, fingerprints_);
+    return out;
+}
+
+inline ElementIndex ElementIndex::deserialize(std::string_view data)
+{
+    auto load = [&data](size_t at, auto &v)
+    {
+        std::memcpy(&v, data.data() + at, sizeof(v));
+    };
+
+    uint32_t ver = 0, flags = 0;
+    uint64_t count = 0;
+    ElementIndex index;
+    if (data.size() < header_size || std::memcmp(data.data(), magic, sizeof(magic)) != 0)
+        LIBJSON_THROW(std::runtime_error("Not an element index"));
+    load(4, ver);
+    load(8, flags);
+    load(16, count);
+    load(24, index.sourceSize_);
+
+    const uint64_t arrays = (flags & 1) ? 3 : 2;
+    if (ver != version || count > (data.size() - header_size) / (arrays * sizeof(uint64_t)) ||
+        data.size() != header_size + arrays * count * sizeof(uint64_t))
+        LIBJSON_THROW(std::runtime_error("Invalid element index"));
+
+    auto loadAll = [&](size_t which, std::vector<uint64_t> &values)
+    {
+        values.resize(count);
+        std::memcpy(values.data(), data.data() + header_size + which * count * sizeof(uint64_t),
+                    count * sizeof(uint64_t));
+    };
+    loadAll(0, index.offsets_);
+    loadAll(1, index.lengths_);
+    index.fingerprinted_ = flags & 1;
+    if (index.fingerprinted_)
+        loadAll(2, index.fingerprints_);
+    return index;
+}
+
+inline void ElementIndex::save(const std::string &path) const
+{
+    std::string bytes = serialize();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+        LIBJSON_THROW(std::runtime_error("Failed to write element index: " + path));
+}
+
+inline ElementIndex ElementIndex::load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        LIBJSON_THROW(std::runtime_error("Failed to open element index: " + path));
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return deserialize(bytes);
+}
+
+[[noreturn]] inline void ElementIndexBuilder::error(uint64_t pos, const char *what)
+{
+    LIBJSON_THROW(std::runtime_error(std::string(what) + " at offset " + std::to_string(pos)));
+}
+
+inline void ElementIndexBuilder::begin(uint64_t pos, char c)
+{
+    open_ = true;
+    container_ = c == '{' || c == '[';
+    object_ = c == '{';
+    start_ = pos;
+    fingerprint_ = 0;
+}
+
+inline void ElementIndexBuilder::end()
+{
+    index_.offsets_.push_back(start_);
+    index_.lengths_.push_back(last_ - start_);
+    if (fingerprints_)
+        index_.fingerprints_.push_back(fingerprint_);
+    open_ = false;
+}
+
+// Escaped keys are decoded so they fingerprint like the lookup key.
+inline void ElementIndexBuilder::keyDone()
+{
+    std::string_view key = key_;
+    if (key.find('\\') != std::string_view::npos)
+    {
+        lexer_.reset("\"" + key_ + "\"");
+        lexer_.nextToken(token_);
+        if (token_.type == Token::STRING)
+            key = token_.lexeme;
+    }
+    fingerprint_ |= ElementIndex::fingerprint(key);
+}
+
+inline void ElementIndexBuilder::feed(std::string_view chunk)
+{
+    const char *p = chunk.data();
+    const size_t n = chunk.size();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (inString_)
+        {
+            if (escape_)
+            {
+                escape_ = false;
+                if (inKey_)
+                    key_ += p[i];
+                continue;
+            }
+            bool ascii = true;
+            size_t j = Utf8::findSpecial(p, i, n, ascii);
+            if (inKey_)
+                key_.append(p + i, j - i);
+            i = j;
+            if (i == n)
+                break;
+            if (p[i] == '\\')
+            {
+                escape_ = true;
+                if (inKey_)
+                    key_ += '\\';
+                continue;
+            }
+            if (p[i] != '"')
+            {
+                // Control character; the index does not validate.
+                if (inKey_)
+                    key_ += p[i];
+                continue;
+            }
+            inString_ = false;
+            last_ = offset_ + i + 1;
+            if (inKey_)
+            {
+                inKey_ = false;
+                keyDone();
+            }
+            continue;
+        }
+
+        const char c = p[i];
+        const uint64_t pos = offset_ + i;
+        if (CharClass::is(c, CharClass::WHITESPACE))
+        {
+            if (c == '\n' && format_ == NDJSON && depth_ == 0 && open_)
+                end();
+            continue;
+        }
+
+        if (depth_ < base_)
+        {
+            if (rootClosed_ || c != '[')
+                error(pos, "Expected a single top-level array");
+            depth_ = 1;
+            continue;
+        }
+
+        if (depth_ == base_)
+        {
+            if (format_ == ARRAY && (c == ',' || c == ']'))
+            {
+                if (open_)
+                    end();
+                else if (c == ',')
+                    error(pos, "Unexpected ','");
+                if (c == ']')
+                {
+                    depth_ = 0;
+                    rootClosed_ = true;
+                }
+                continue;
+            }
+            if (!open_)
+                begin(pos, c);
+            else if (container_)
+                error(pos, format_ == ARRAY ? "Expected ',' or ']'" : "Expected a newline between records");
+        }
+
+        last_ = pos + 1;
+        switch (c)
+        {
+        case '"':
+            inString_ = true;
+            if (fingerprints_ && object_ && expectKey_ && depth_ == base_ + 1)
+            {
+                inKey_ = true;
+                expectKey_ = false;
+                key_.clear();
+            }
+            break;
+        case '{':
+        case '[':
+            ++depth_;
+            if (depth_ == base_ + 1)
+                expectKey_ = c == '{';
+            break;
+        case '}':
+        case ']':
+            if (depth_ == base_)
+                error(pos, "Unbalanced brackets");
+            --depth_;
+            break;
+        case ',':
+            if (depth_ == base_ + 1)
+                expectKey_ = object_;
+            break;
+        default:
+            break;
+        }
+    }
+    offset_ += n;
+}
+
+inline void ElementIndexBuilder::feed(std::istream &in)
+{
+    auto chunk = std::make_unique<char[]>(chunk_size);
+    while (in)
+    {
+        in.read(chunk.get(), static_cast<std::streamsize>(chunk_size));
+        std::streamsize got = in.gcount();
+        if (got <= 0)
+            break;
+        feed(std::string_view(chunk.get(), static_cast<size_t>(got)));
+    }
+}
+
+inline ElementIndex ElementIndexBuilder::finish()
+{
+    if (inString_ || (format_ == ARRAY ? !rootClosed_ : depth_ > 0))
+        error(offset_, "Unexpected end of input");
+    if (open_)
+        end();
+    index_.sourceSize_ = offset_;
+    index_.fingerprinted_ = fingerprints_;
+    return std::move(index_);
+}
+
+inline ElementIndex ElementIndexBuilder::build(const std::string &path, Format format, bool fingerprints)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        LIBJSON_THROW(std::runtime_error("Failed to open " + path));
+    ElementIndexBuilder builder(format, fingerprints);
+    builder.feed(in);
+    return builder.finish();
+}
+
+#endif // ELEMENTINDEX_H
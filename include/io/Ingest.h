@@ -0,0 +1,633 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include "json/Config.h"
+#include "json/Json.h"
+#include "parser/Parser.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBJSON_INGEST 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define LIBJSON_INGEST_URING 1
+#endif
+
+#ifdef LIBJSON_INGEST_URING
+
+// Minimal io_uring ring driven through the raw syscalls: vectored reads
+// in, completions out. One thread submits and reaps.
+class IoUring
+{
+public:
+    struct Completion
+    {
+        uint64_t tag;
+        int32_t result;
+    };
+
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    // False with errno set if the kernel has no io_uring or forbids it.
+    bool setup(unsigned entries);
+
+    // Queues a read of iov->iov_len bytes at offset; iov must stay valid
+    // until the read completes.
+    void read(int fd, const iovec *iov, uint64_t offset, uint64_t tag);
+
+    // Submits the queued reads and waits until at least one completes;
+    // false with errno set if the kernel refused.
+    bool wait();
+
+    template <typename F>
+    void reap(F &&onCompletion);
+
+private:
+    int fd_ = -1;
+    void *sq_ = MAP_FAILED;
+    void *cq_ = MAP_FAILED;
+    size_t sqSize_ = 0;
+    size_t cqSize_ = 0;
+    io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesSize_ = 0;
+
+    unsigned *sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned *sqArray_ = nullptr;
+    unsigned *cqHead_ = nullptr;
+    unsigned *cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned pending_ = 0;
+
+    template <typename T>
+    static T *at(void *base, uint32_t offset) { return reinterpret_cast<T *>(static_cast<char *>(base) + offset); }
+};
+
+inline bool IoUring::setup(unsigned entries)
+{
+    io_uring_params params{};
+    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0)
+        return false;
+
+    sqSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+        sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    sq_ = ::mmap(nullptr, sqSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ != MAP_FAILED)
+        cq_ = single ? sq_
+                     : ::mmap(nullptr, cqSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                              IORING_OFF_CQ_RING);
+    if (cq_ != MAP_FAILED)
+        sqes_ = static_cast<io_uring_sqe *>(::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED)
+        return false;
+
+    sqTail_ = at<unsigned>(sq_, params.sq_off.tail);
+    sqMask_ = *at<unsigned>(sq_, params.sq_off.ring_mask);
+    sqArray_ = at<unsigned>(sq_, params.sq_off.array);
+    cqHead_ = at<unsigned>(cq_, params.cq_off.head);
+    cqTail_ = at<unsigned>(cq_, params.cq_off.tail);
+    cqMask_ = *at<unsigned>(cq_, params.cq_off.ring_mask);
+    cqes_ = at<io_uring_cqe>(cq_, params.cq_off.cqes);
+    return true;
+}
+
+inline IoUring::~IoUring()
+{
+    if (sqes_ != MAP_FAILED)
+        ::munmap(sqes_, sqesSize_);
+    if (cq_ != MAP_FAILED && cq_ != sq_)
+        ::munmap(cq_, cqSize_);
+    if (sq_ != MAP_FAILED)
+        ::munmap(sq_, sqSize_);
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+inline void IoUring::read(int fd, const iovec *iov, uint64_t offset, uint64_t tag)
+{
+    // Only this thread writes the tail; the kernel reads it.
+    unsigned tail = *sqTail_;
+    unsigned slot = tail & sqMask_;
+    io_uring_sqe &sqe = sqes_[slot];
+    std::memset(&sqe, 0, sizeof(sqe));
+    // READV rather than READ so kernels from 5.1 on are supported.
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(iov);
+    sqe.len = 1;
+    sqe.off = offset;
+    sqe.user_data = tag;
+    sqArray_[slot] = slot;
+    std::atomic_ref<unsigned>(*sqTail_).store(tail + 1, std::memory_order_release);
+    ++pending_;
+}
+
+inline bool IoUring::wait()
+{
+    for (;;)
+    {
+        long n = ::syscall(__NR_io_uring_enter, fd_, pending_, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (n >= 0)
+        {
+            pending_ -= static_cast<unsigned>(n);
+            return true;
+        }
+        if (errno != EINTR)
+            return false;
+    }
+}
+
+template <typename F>
+void IoUring::reap(F &&onCompletion)
+{
+    unsigned head = std::atomic_ref<unsigned>(*cqHead_).load(std::memory_order_relaxed);
+    unsigned tail = std::atomic_ref<unsigned>(*cqTail_).load(std::memory_order_acquire);
+    for (; head != tail; ++head)
+    {
+        const io_uring_cqe &cqe = cqes_[head & cqMask_];
+        Completion c{cqe.user_data, cqe.res};
+        std::atomic_ref<unsigned>(*cqHead_).store(head + 1, std::memory_order_release);
+        onCompletion(c);
+    }
+}
+
+#endif // LIBJSON_INGEST_URING
+
+// Reads and parses many files with the two stages overlapped: up to
+// queueDepth reads are in flight (io_uring where the kernel allows it,
+// otherwise a pool of pread threads) while `threads` workers parse the
+// files already read. Reads fill a fixed pool of queueDepth + threads
+// reusable buffers, so reading stalls when parsing falls behind.
+//
+// The callback gets each file's index in paths and its document, or a
+// message naming the file if it could not be read or parsed. It runs on
+// the worker threads, concurrently and in completion order. If it throws,
+// no further files are delivered and run() rethrows once in-flight reads
+// have drained. run() must not be called concurrently on one instance.
+class IngestPipeline
+{
+public:
+    enum Backend
+    {
+        AUTO,
+        IO_URING,
+        PREAD
+    };
+
+    static constexpr size_t default_queue_depth = 32;
+
+    using result_t = std::expected<Json, std::string>;
+    using callback_t = std::function<void(size_t index, result_t result)>;
+
+    // AUTO uses io_uring when available; IO_URING throws
+    // std::system_error when it is not.
+    explicit IngestPipeline(size_t threads = 0, size_t queueDepth = default_queue_depth, Backend backend = AUTO);
+
+    IngestPipeline(const IngestPipeline &) = delete;
+    IngestPipeline &operator=(const IngestPipeline &) = delete;
+
+    // IO_URING or PREAD.
+    Backend backend() const { return backend_; }
+
+    void run(const std::vector<std::string> &paths, const callback_t &callback);
+
+private:
+    struct Buffer
+    {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t size = 0;
+    };
+
+    struct Job
+    {
+        size_t index;
+        Buffer *buffer;
+        std::string error;
+    };
+
+    size_t threads_;
+    size_t queueDepth_;
+    Backend backend_;
+#ifdef LIBJSON_INGEST_URING
+    std::unique_ptr<IoUring> ring_;
+#endif
+    std::vector<Buffer> buffers_;
+
+    // Per-run state shared by the reading and parsing stages.
+    std::mutex mutex_;
+    std::condition_variable bufferFreed_;
+    std::condition_variable jobReady_;
+    std::vector<Buffer *> free_;
+    std::deque<Job> jobs_;
+    bool reading_ = false;
+    std::atomic<bool> failed_{false};
+    std::exception_ptr failure_;
+
+    Buffer *acquire(bool wait);
+    void release(Buffer *buffer);
+    void post(Job job);
+    void parseWorker(const std::vector<std::string> &paths, const callback_t &callback);
+
+    // Opens path and sizes buffer for it; returns the descriptor, or -1
+    // with errno set.
+    static int openFile(const std::string &path, Buffer &buffer);
+    static std::string ioError(const std::string &path, int error);
+
+    void readPread(const std::vector<std::string> &paths);
+#ifdef LIBJSON_INGEST_URING
+    void readUring(const std::vector<std::string> &paths);
+#endif
+};
+
+inline IngestPipeline::IngestPipeline(size_t threads, size_t queueDepth, Backend backend)
+    : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+      queueDepth_(std::clamp<size_t>(queueDepth, 1, 4096)),
+      backend_(PREAD),
+      buffers_(queueDepth_ + threads_)
+{
+#ifdef LIBJSON_INGEST_URING
+    if (backend != PREAD)
+    {
+        ring_ = std::make_unique<IoUring>();
+        if (ring_->setup(static_cast<unsigned>(queueDepth_)))
+        {
+            backend_ = IO_URING;
+        }
+        else
+        {
+            int error = errno;
+            ring_.reset();
+            if (backend == IO_URING)
+                LIBJSON_THROW(std::system_error(error, std::system_category(), "io_uring_setup"));
+        }
+    }
+#else
+    if (backend == IO_URING)
+        LIBJSON_THROW(std::system_error(ENOSYS, std::system_category(), "io_uring"));
+#endif
+}
+
+inline IngestPipeline::Buffer *IngestPipeline::acquire(bool wait)
+{
+    std::unique_lock lock(mutex_);
+    if (wait)
+        bufferFreed_.wait(lock, [this] { return !free_.empty(); });
+    if (free_.empty())
+        return nullptr;
+    Buffer *buffer = free_.back();
+    free_.pop_back();
+    return buffer;
+}
+
+inline void IngestPipeline::release(Buffer *buffer)
+{
+    {
+        std::lock_guard lock(mutex_);
+        free_.push_back(buffer);
+    }
+    bufferFreed_.notify_one();
+}
+
+inline void IngestPipeline::post(Job job)
+{
+    {
+        std::lock_guard lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobReady_.notify_one();
+}
+
+inline int IngestPipeline::openFile(const std::string &path, Buffer &buffer)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    buffer.size = static_cast<size_t>(st.st_size);
+    if (buffer.capacity < buffer.size)
+    {
+        buffer.capacity = std::max(buffer.size, buffer.capacity * 2);
+        buffer.data = std::make_unique_for_overwrite<char[]>(buffer.capacity);
+    }
+    return fd;
+}
+
+inline std::string IngestPipeline::ioError(const std::string &path, int error)
+{
+    return path + ": " + std::system_category().message(error);
+}
+
+inline void IngestPipeline::parseWorker(const std::vector<std::string> &paths, const callback_t &callback)
+{
+    Parser parser;
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock lock(mutex_);
+            jobReady_.wait(lock, [this] { return !jobs_.empty() || !reading_; });
+            if (jobs_.empty())
+                return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        // After a failure keep draining so the reader is never starved of buffers.
+        if (!failed_.load(std::memory_order_relaxed))
+        {
+            LIBJSON_TRY
+            {
+                if (!job.buffer)
+                {
+                    callback(job.index, std::unexpected(std::move(job.error)));
+                }
+                else
+                {
+                    auto parsed = parser.tryParse(std::string_view(job.buffer->data.get(), job.buffer->size));
+                    release(std::exchange(job.buffer, nullptr));
+                    if (parsed)
+                        callback(job.index, std::move(*parsed));
+                    else
+                        callback(job.index, std::unexpected(paths[job.index] + ": " + parsed.error().describe()));
+                }
+            }
+            LIBJSON_CATCH(...)
+            {
+                std::lock_guard lock(mutex_);
+                if (!failed_.exchange(true))
+                    failure_ = std::current_exception();
+            }
+        }
+        if (job.buffer)
+            release(job.buffer);
+    }
+}
+
+inline void IngestPipeline::readPread(const std::vector<std::string> &paths)
+{
+    std::atomic<size_t> next{0};
+    auto reader = [&]()
+    {
+        for (size_t i; !failed_.load(std::memory_order_relaxed) &&
+                       (i = next.fetch_add(1, std::memory_order_relaxed)) < paths.size();)
+        {
+            Buffer *buffer = acquire(true);
+            int fd = openFile(paths[i], *buffer);
+            int error = fd < 0 ? errno : 0;
+            size_t done = 0;
+            while (fd >= 0 && done < buffer->size)
+            {
+                ssize_t n = ::pread(fd, buffer->data.get() + done, buffer->size - done, static_cast<off_t>(done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                    error = errno;
+                if (n <= 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+            if (fd >= 0)
+                ::close(fd);
+
+            if (error)
+            {
+                release(buffer);
+                post({i, nullptr, ioError(paths[i], error)});
+            }
+            else
+            {
+                buffer->size = done;
+                post({i, buffer, {}});
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::min(queueDepth_, paths.size()); ++t)
+        pool.emplace_back(reader);
+    reader();
+    for (auto &t : pool)
+        t.join();
+}
+
+#ifdef LIBJSON_INGEST_URING
+
+inline void IngestPipeline::readUring(const std::vector<std::string> &paths)
+{
+    struct Read
+    {
+        size_t index;
+        int fd;
+        Buffer *buffer;
+        size_t done;
+        iovec iov;
+    };
+
+    std::vector<Read> reads(queueDepth_);
+    std::vector<uint64_t> idle(queueDepth_);
+    for (size_t s = 0; s < queueDepth_; ++s)
+        idle[s] = queueDepth_ - 1 - s;
+
+    auto submit = [this](Read &r, uint64_t tag)
+    {
+        r.iov.iov_base = r.buffer->data.get() + r.done;
+        r.iov.iov_len = r.buffer->size - r.done;
+        ring_->read(r.fd, &r.iov, r.done, tag);
+    };
+    auto finish = [&](uint64_t tag, int error)
+    {
+        Read &r = reads[tag];
+        ::close(r.fd);
+        if (error)
+        {
+            release(r.buffer);
+            post({r.index, nullptr, ioError(paths[r.index], error)});
+        }
+        else
+        {
+            r.buffer->size = r.done;
+            post({r.index, r.buffer, {}});
+        }
+        idle.push_back(tag);
+    };
+
+    // Waits out every submitted read before throwing, so neither the kernel
+    // nor a later run touches this run's buffers, iovecs or tags. If the
+    // ring cannot even be drained it is dropped for the pread backend, and
+    // the buffers still owned by the kernel are abandoned rather than reused.
+    auto abandon = [&](int error)
+    {
+        for (int attempts = 0; idle.size() < queueDepth_ && attempts < 1000; ++attempts)
+        {
+            ring_->reap([&](const IoUring::Completion &c)
+                        {
+                            Read &r = reads[c.tag];
+                            ::close(r.fd);
+                            release(r.buffer);
+                            idle.push_back(c.tag);
+                        });
+            if (idle.size() < queueDepth_ && !ring_->wait() && errno != EAGAIN && errno != EBUSY)
+                break;
+        }
+        if (idle.size() < queueDepth_)
+        {
+            std::vector<bool> busy(queueDepth_, true);
+            for (uint64_t tag : idle)
+                busy[tag] = false;
+            for (size_t tag = 0; tag < queueDepth_; ++tag)
+            {
+                if (!busy[tag])
+                    continue;
+                ::close(reads[tag].fd);
+                reads[tag].buffer->data.release();
+                reads[tag].buffer->capacity = 0;
+                release(reads[tag].buffer);
+            }
+            ring_.reset();
+            backend_ = PREAD;
+        }
+        LIBJSON_THROW(std::system_error(error, std::system_category(), "io_uring_enter"));
+    };
+
+    size_t next = 0;
+    while (true)
+    {
+        while (next < paths.size() && !idle.empty() && !failed_.load(std::memory_order_relaxed))
+        {
+            // Block for a buffer only when no read is left to wait on.
+            Buffer *buffer = acquire(idle.size() == queueDepth_);
+            if (!buffer)
+                break;
+            size_t i = next++;
+            int fd = openFile(paths[i], *buffer);
+            if (fd < 0)
+            {
+                int error = errno;
+                release(buffer);
+                post({i, nullptr, ioError(paths[i], error)});
+                continue;
+            }
+            uint64_t tag = idle.back();
+            idle.pop_back();
+            reads[tag] = {i, fd, buffer, 0, {}};
+            if (buffer->size == 0)
+                finish(tag, 0);
+            else
+                submit(reads[tag], tag);
+        }
+        if (idle.size() == queueDepth_)
+            break;
+
+        // EAGAIN and EBUSY clear once completions are reaped.
+        if (!ring_->wait() && errno != EAGAIN && errno != EBUSY)
+            abandon(errno);
+        ring_->reap([&](const IoUring::Completion &c)
+                    {
+                        Read &r = reads[c.tag];
+                        if (c.result == -EINTR || c.result == -EAGAIN)
+                            submit(r, c.tag);
+                        else if (c.result < 0)
+                            finish(c.tag, -c.result);
+                        else if (c.result > 0 && (r.done += static_cast<size_t>(c.result)) < r.buffer->size)
+                            submit(r, c.tag);
+                        else
+                            finish(c.tag, 0);
+                    });
+    }
+}
+
+#endif
+
+inline void IngestPipeline::run(const std::vector<std::string> &paths, const callback_t &callback)
+{
+    free_.clear();
+    for (Buffer &b : buffers_)
+        free_.push_back(&b);
+    jobs_.clear();
+    reading_ = true;
+    failed_ = false;
+    failure_ = nullptr;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads_; ++t)
+        workers.emplace_back(&IngestPipeline::parseWorker, this, std::cref(paths), std::cref(callback));
+
+    std::exception_ptr readFailure;
+    LIBJSON_TRY
+    {
+#ifdef LIBJSON_INGEST_URING
+        if (backend_ == IO_URING)
+            readUring(paths);
+        else
+#endif
+            readPread(paths);
+    }
+    LIBJSON_CATCH(...)
+    {
+        readFailure = std::current_exception();
+        failed_ = true;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        reading_ = false;
+    }
+    jobReady_.notify_all();
+    for (auto &t : workers)
+        t.join();
+
+    if (readFailure)
+        std::rethrow_exception(readFailure);
+    if (failure_)
+        std::rethrow_exception(failure_);
+}
+
+#endif // unix
+
+#endif // INGEST_H
@@ -0,0 +1,129 @@
+#ifndef SINK_H
+#define SINK_H
+
+#include "json/Config.h"
+
+#include <cerrno>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <climits>
+#include <string_view>
+#include <sys/uio.h>
+#include <unistd.h>
+#define LIBJSON_SINK_FD 1
+#endif
+
+// Output sinks used by the streaming components. A sink is any type with
+// `void write(const char *data, size_t size)`.
+
+class StringSink
+{
+public:
+    explicit StringSink(std::string &out) : out_(&out) {}
+
+    void write(const char *data, size_t size) { out_->append(data, size); }
+
+private:
+    std::string *out_;
+};
+
+class OstreamSink
+{
+public:
+    explicit OstreamSink(std::ostream &os) : os_(&os) {}
+
+    void write(const char *data, size_t size)
+    {
+        if (!os_->write(data, static_cast<std::streamsize>(size)))
+            LIBJSON_THROW(std::runtime_error("Failed to write to stream"));
+    }
+
+private:
+    std::ostream *os_;
+};
+
+class CallbackSink
+{
+public:
+    using callback_t = std::function<void(const char *, size_t)>;
+
+    explicit CallbackSink(callback_t callback) : callback_(std::move(callback)) {}
+
+    void write(const char *data, size_t size) { callback_(data, size); }
+
+private:
+    callback_t callback_;
+};
+
+#ifdef LIBJSON_SINK_FD
+
+class FdSink
+{
+public:
+    explicit FdSink(int fd) : fd_(fd) {}
+
+    void write(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::write(fd_, data, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                LIBJSON_THROW(std::runtime_error("Failed to write to file descriptor"));
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    // Gather write of several buffers, in order, with as few syscalls as
+    // the kernel allows.
+    void writev(const std::string_view *parts, size_t count)
+    {
+        size_t offset = 0;
+        while (count > 0)
+        {
+            iovec iov[IOV_MAX < 1024 ? IOV_MAX : 1024];
+            int n = 0;
+            for (; n < static_cast<int>(std::size(iov)) && static_cast<size_t>(n) < count; ++n)
+            {
+                size_t skip = n == 0 ? offset : 0;
+                iov[n].iov_base = const_cast<char *>(parts[n].data() + skip);
+                iov[n].iov_len = parts[n].size() - skip;
+            }
+
+            ssize_t written = ::writev(fd_, iov, n);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                LIBJSON_THROW(std::runtime_error("Failed to write to file descriptor"));
+            }
+
+            size_t left = static_cast<size_t>(written) + offset;
+            while (count > 0 && left >= parts->size())
+            {
+                left -= parts->size();
+                ++parts;
+                --count;
+            }
+            offset = left;
+        }
+    }
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+#endif
+
+#endif // SINK_H
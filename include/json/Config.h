@@ -0,0 +1,21 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// Error reporting hooks. With exceptions disabled (-fno-exceptions) a throw
+// prints the exception's message and aborts, and try blocks always run
+// their body; the non-throwing APIs (Parser::tryParse) are unaffected.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define LIBJSON_EXCEPTIONS 1
+#define LIBJSON_THROW(exception) throw exception
+#define LIBJSON_TRY try
+#define LIBJSON_CATCH(declaration) catch (declaration)
+#else
+#define LIBJSON_THROW(exception) (std::fputs((exception).what(), stderr), std::fputc('\n', stderr), std::abort())
+#define LIBJSON_TRY if (true)
+#define LIBJSON_CATCH(declaration) else
+#endif
+
+#endif // CONFIG_H
@@ -1,6 +1,11 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include "Config.h"
+#include "JsonKey.h"
+#include "JsonNumber.h"
+#include "MemoryUsage.h"
+
 #include <variant>
 #include <vector>
 #include <string>
@@ -8,14 +13,22 @@
 #include <type_traits>
 #include <initializer_list>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
 
 class JsonValue;
 
 class Json
 {
 public:
-    using object_t = std::unordered_map<std::string, JsonValue>;
+    // Lookups take JsonKey (or anything convertible to it) without building
+    // a std::string.
+    using object_t = std::unordered_map<std::string, JsonValue, JsonKeyHash, std::equal_to<>>;
 
     Json() = default;
     Json(const Json &) = default;
@@ -27,17 +40,50 @@ public:
         : object_(list) {}
 
     JsonValue &operator[](const std::string &key) { return object_[key]; }
-    JsonValue &operator[](const char *key) { return object_[std::string(key)]; }
+    JsonValue &operator[](std::string &&key) { return object_[std::move(key)]; }
+    // Allocate a key only when it has to be inserted.
+    JsonValue &operator[](const char *key) { return (*this)[JsonKey(key)]; }
+    JsonValue &operator[](const JsonKey &key);
+
+    // Accept string literals, std::string and std::string_view through
+    // JsonKey's implicit constructors.
+    auto find(const JsonKey &key) { return object_.find(key); }
+    auto find(const JsonKey &key) const { return object_.find(key); }
+
+    bool contains(const JsonKey &key) const;
+
+    // Throw std::out_of_range if the key is absent.
+    JsonValue &at(const JsonKey &key);
+    const JsonValue &at(const JsonKey &key) const;
+
+    template <typename... Args>
+    auto try_emplace(std::string &&key, Args &&...args)
+    {
+        return object_.try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
 
     bool empty() const { return object_.empty(); }
+    size_t size() const { return object_.size(); }
 
     auto begin() { return object_.begin(); }
     auto end() { return object_.end(); }
     auto begin() const { return object_.begin(); }
     auto end() const { return object_.end(); }
 
+    // Heap bytes owned by this object (not counting the Json itself).
+    MemoryUsage memory_usage() const;
+    // Trims vector and string capacity and rehashes maps to the smallest
+    // bucket count for their size. Shared containers are left untouched.
+    void shrink_to_fit();
+
+    friend bool operator==(const Json &a, const Json &b);
+
 private:
+    friend class JsonValue;
+
     object_t object_;
+
+    void accumulate(MemoryUsage &usage, std::vector<const void *> &seen) const;
 };
 
 class JsonValue
@@ -50,6 +96,11 @@ public:
     using number_integer_t = int64_t;
     using number_float_t = double;
     using nullptr_t = std::nullptr_t;
+    using number_raw_t = JsonNumber;
+    using shared_object_t = std::shared_ptr<const object_t>;
+    using shared_array_t = std::shared_ptr<const array_t>;
+    using packed_integer_t = std::vector<number_integer_t>;
+    using packed_float_t = std::vector<number_float_t>;
 
     using value_t = std::variant<
         object_t,
@@ -58,7 +109,12 @@ public:
         boolean_t,
         number_integer_t,
         number_float_t,
-        nullptr_t>;
+        nullptr_t,
+        shared_object_t,
+        shared_array_t,
+        number_raw_t,
+        packed_integer_t,
+        packed_float_t>;
 
     JsonValue() = default;
     JsonValue(const JsonValue &) = default;
@@ -78,24 +134,118 @@ public:
 
     JsonValue(std::initializer_list<JsonValue> list) : value_(array_t(list)) {}
 
-    explicit operator string_t() const { return std::get<string_t>(value_); }
-    explicit operator object_t() const { return std::get<object_t>(value_); }
-    explicit operator array_t() const { return std::get<array_t>(value_); }
+    explicit operator string_t() const & { return get<string_t>(); }
+    explicit operator object_t() const & { return get<object_t>(); }
+    explicit operator array_t() const &
+    {
+        if (is_packed())
+            return JsonValue(*this).get<array_t>();
+        return get<array_t>();
+    }
+    explicit operator string_t() && { return std::move(*this).template get<string_t>(); }
+    explicit operator object_t() && { return std::move(*this).template get<object_t>(); }
+    explicit operator array_t() && { return std::move(*this).template get<array_t>(); }
     explicit operator boolean_t() const { return std::get<boolean_t>(value_); }
-    explicit operator number_integer_t() const { return std::get<number_integer_t>(value_); }
-    explicit operator number_float_t() const { return std::get<number_float_t>(value_); }
+    explicit operator number_integer_t() const
+    {
+        if (auto n = std::get_if<number_raw_t>(&value_))
+            return n->get<number_integer_t>();
+        return std::get<number_integer_t>(value_);
+    }
+    explicit operator number_float_t() const
+    {
+        if (auto n = std::get_if<number_raw_t>(&value_))
+            return n->get<number_float_t>();
+        return std::get<number_float_t>(value_);
+    }
 
     bool is_null() const { return std::holds_alternative<nullptr_t>(value_); }
     bool is_boolean() const { return std::holds_alternative<boolean_t>(value_); }
     bool is_integer() const { return std::holds_alternative<number_integer_t>(value_); }
     bool is_float() const { return std::holds_alternative<number_float_t>(value_); }
     bool is_string() const { return std::holds_alternative<string_t>(value_); }
-    bool is_array() const { return std::holds_alternative<array_t>(value_); }
-    bool is_object() const { return std::holds_alternative<object_t>(value_); }
+    bool is_array() const { return std::holds_alternative<array_t>(value_) || std::holds_alternative<shared_array_t>(value_) || is_packed(); }
+    bool is_object() const { return std::holds_alternative<object_t>(value_) || std::holds_alternative<shared_object_t>(value_); }
+    bool is_raw_number() const { return std::holds_alternative<number_raw_t>(value_); }
+    bool is_shared() const { return std::holds_alternative<shared_object_t>(value_) || std::holds_alternative<shared_array_t>(value_); }
+    // A numeric array stored as a contiguous packed_integer_t or
+    // packed_float_t. is_array() is also true, but get<array_t>() const
+    // does not apply: read it through packed<T>(). Mutable access through
+    // get<array_t>() & converts it back to a generic array.
+    bool is_packed() const { return std::holds_alternative<packed_integer_t>(value_) || std::holds_alternative<packed_float_t>(value_); }
+    template <typename T>
+    bool is_packed() const { return std::holds_alternative<std::vector<T>>(value_); }
+
+    template <typename T>
+    const T &get() const &
+    {
+        if constexpr (shareable<T>)
+            if (auto p = std::get_if<std::shared_ptr<const T>>(&value_))
+                return **p;
+        return std::get<T>(value_);
+    }
+
+    template <typename T>
+    T &get() &
+    {
+        if constexpr (std::is_same_v<T, array_t>)
+            unpack();
+        if constexpr (shareable<T>)
+            detach<T>();
+        return std::get<T>(value_);
+    }
+
+    template <typename T>
+    T get() &&
+    {
+        if constexpr (std::is_same_v<T, array_t>)
+            unpack();
+        if constexpr (shareable<T>)
+            detach<T>();
+        return std::get<T>(std::move(value_));
+    }
+
+    // Elements of a packed array; T is number_integer_t or number_float_t
+    // and must match the stored representation.
+    template <typename T>
+    std::span<const T> packed() const { return std::get<std::vector<T>>(value_); }
+    template <typename T>
+    std::span<T> packed() & { return std::get<std::vector<T>>(value_); }
+
+    // Stores a non-empty array in packed form: packed_integer_t if every
+    // element is an integer, packed_float_t if every element is a float.
+    // Mixed arrays stay unpacked so element types never change. Returns
+    // whether the array is (now) packed.
+    bool pack();
+    // Converts a packed array back to array_t; no-op for other values.
+    void unpack();
+
+    // Converts this container and every container below it into the shared,
+    // reference-counted representation. Copies then cost O(1); the first
+    // mutable access through get<T>() & copies only the touched level.
+    JsonValue &share();
+
+    // Deep structural equality; key order is irrelevant and numbers compare
+    // by value whatever their representation (see NumberKey).
+    friend bool operator==(const JsonValue &a, const JsonValue &b);
+
+    // See Json::memory_usage() and Json::shrink_to_fit(). Shared containers
+    // are counted once per call however often they are referenced.
+    MemoryUsage memory_usage() const;
+    void shrink_to_fit();
 
 private:
+    friend class Json;
+
     value_t value_;
 
+    void accumulate(MemoryUsage &usage, std::vector<const void *> &seen) const;
+    static void accumulate(const array_t &arr, MemoryUsage &usage, std::vector<const void *> &seen);
+
+    static bool numberKey(const JsonValue &v, NumberKey &key);
+    size_t arraySize() const;
+    bool elementKey(size_t i, NumberKey &key) const;
+
     template <typename T>
     static value_t convert(T &&val)
     {
@@ -105,7 +255,7 @@ private:
         else if constexpr (std::is_same_v<DecayT, const char *>)
             return string_t(val);
         else if constexpr (std::is_same_v<DecayT, string_t>)
-            return val;
+            return std::forward<T>(val);
         else if constexpr (std::is_integral_v<DecayT> && !std::is_same_v<DecayT, bool>)
             return static_cast<number_integer_t>(val);
         else if constexpr (std::is_same_v<DecayT, boolean_t>)
@@ -113,19 +263,352 @@ private:
         else if constexpr (std::is_floating_point_v<DecayT>)
             return static_cast<number_float_t>(val);
         else if constexpr (std::is_same_v<DecayT, array_t>)
-            return val;
+            return std::forward<T>(val);
         else if constexpr (std::is_same_v<DecayT, object_t>)
-            return val;
+            return std::forward<T>(val);
+        else if constexpr (std::is_same_v<DecayT, number_raw_t>)
+            return std::forward<T>(val);
+        else if constexpr (std::is_same_v<DecayT, packed_integer_t> || std::is_same_v<DecayT, packed_float_t>)
+            return std::forward<T>(val);
         else if constexpr (std::is_same_v<DecayT, JsonValue>)
-            return val.value_;
+            return std::forward<T>(val).value_;
         else
             static_assert(always_false<DecayT>, "Unsupported type for JsonValue");
     }
 
     template <typename>
     inline static constexpr bool always_false = false;
+
+    template <typename T>
+    inline static constexpr bool shareable = std::is_same_v<T, object_t> || std::is_same_v<T, array_t>;
+
+    // Always copies: use_count() is a relaxed load and cannot prove that no
+    // other thread is copying or releasing the same container right now.
+    template <typename T>
+    void detach()
+    {
+        if (auto p = std::get_if<std::shared_ptr<const T>>(&value_))
+        {
+            std::shared_ptr<const T> shared = std::move(*p);
+            value_ = T(*shared);
+        }
+    }
 };
 
+inline JsonValue &JsonValue::share()
+{
+    if (auto o = std::get_if<object_t>(&value_))
+    {
+        for (auto &kv : *o)
+            kv.second.share();
+        value_ = shared_object_t(std::make_shared<object_t>(std::move(*o)));
+    }
+    else if (auto a = std::get_if<array_t>(&value_))
+    {
+        for (auto &v : *a)
+            v.share();
+        value_ = shared_array_t(std::make_shared<array_t>(std::move(*a)));
+    }
+    return *this;
+}
+
+inline bool JsonValue::pack()
+{
+    if (is_packed())
+        return true;
+    if (!is_array())
+        return false;
+
+    const array_t &arr = std::as_const(*this).get<array_t>();
+    if (arr.empty())
+        return false;
+    const bool floats = std::holds_alternative<number_float_t>(arr.front().value_);
+    for (const auto &v : arr)
+    {
+        if (floats ? !std::holds_alternative<number_float_t>(v.value_)
+                   : !std::holds_alternative<number_integer_t>(v.value_))
+            return false;
+    }
+
+    if (!floats)
+    {
+        packed_integer_t out;
+        out.reserve(arr.size());
+        for (const auto &v : arr)
+            out.push_back(std::get<number_integer_t>(v.value_));
+        value_ = std::move(out);
+        return true;
+    }
+
+    packed_float_t out;
+    out.reserve(arr.size());
+    for (const auto &v : arr)
+        out.push_back(std::get<number_float_t>(v.value_));
+    value_ = std::move(out);
+    return true;
+}
+
+inline void JsonValue::unpack()
+{
+    auto expand = [this](const auto &packed)
+    {
+        array_t out(packed.begin(), packed.end());
+        value_ = std::move(out);
+    };
+    if (auto p = std::get_if<packed_integer_t>(&value_))
+        expand(*p);
+    else if (auto p = std::get_if<packed_float_t>(&value_))
+        expand(*p);
+}
+
+inline JsonValue &Json::operator[](const JsonKey &key)
+{
+    auto it = object_.find(key);
+    if (it == object_.end())
+        it = object_.try_emplace(std::string(key.name())).first;
+    return it->second;
+}
+
+inline bool Json::contains(const JsonKey &key) const
+{
+    return object_.contains(key);
+}
+
+inline JsonValue &Json::at(const JsonKey &key)
+{
+    auto it = object_.find(key);
+    if (it == object_.end())
+        LIBJSON_THROW(std::out_of_range("Key not found: " + std::string(key.name())));
+    return it->second;
+}
+
+inline const JsonValue &Json::at(const JsonKey &key) const
+{
+    auto it = object_.find(key);
+    if (it == object_.end())
+        LIBJSON_THROW(std::out_of_range("Key not found: " + std::string(key.name())));
+    return it->second;
+}
+
+inline MemoryUsage Json::memory_usage() const
+{
+    MemoryUsage usage;
+    std::vector<const void *> seen;
+    accumulate(usage, seen);
+    return usage;
+}
+
+// Nodes are estimated as a next pointer, the key/value pair and a cached
+// hash code.
+inline void Json::accumulate(MemoryUsage &usage, std::vector<const void *> &seen) const
+{
+    constexpr size_t node = sizeof(void *) + sizeof(object_t::value_type) + sizeof(size_t);
+    usage.overhead += object_.bucket_count() * sizeof(void *);
+    usage.containers += object_.size() * node;
+    for (const auto &kv : object_)
+    {
+        usage.add_string(usage.keys, kv.first);
+        kv.second.accumulate(usage, seen);
+    }
+}
+
+inline void Json::shrink_to_fit()
+{
+    for (auto &kv : object_)
+        kv.second.shrink_to_fit();
+    object_.rehash(0);
+}
+
+inline MemoryUsage JsonValue::memory_usage() const
+{
+    MemoryUsage usage;
+    std::vector<const void *> seen;
+    accumulate(usage, seen);
+    return usage;
+}
+
+inline void JsonValue::accumulate(const array_t &arr, MemoryUsage &usage, std::vector<const void *> &seen)
+{
+    usage.containers += arr.size() * sizeof(JsonValue);
+    usage.slack += (arr.capacity() - arr.size()) * sizeof(JsonValue);
+    for (const auto &v : arr)
+        v.accumulate(usage, seen);
+}
+
+inline void JsonValue::accumulate(MemoryUsage &usage, std::vector<const void *> &seen) const
+{
+    // Shared payloads sit in one allocation with their control block.
+    auto firstVisit = [&](const void *p, size_t size)
+    {
+        for (const void *s : seen)
+            if (s == p)
+                return false;
+        seen.push_back(p);
+        usage.containers += size;
+        usage.overhead += 2 * sizeof(void *);
+        return true;
+    };
+
+    auto packed = [&usage](const auto &p)
+    {
+        using T = typename std::decay_t<decltype(p)>::value_type;
+        usage.containers += p.size() * sizeof(T);
+        usage.slack += (p.capacity() - p.size()) * sizeof(T);
+    };
+
+    if (auto s = std::get_if<string_t>(&value_))
+        usage.add_string(usage.strings, *s);
+    else if (auto pi = std::get_if<packed_integer_t>(&value_))
+        packed(*pi);
+    else if (auto pf = std::get_if<packed_float_t>(&value_))
+        packed(*pf);
+    else if (auto n = std::get_if<number_raw_t>(&value_))
+        usage.add_string(usage.strings, n->raw());
+    else if (auto a = std::get_if<array_t>(&value_))
+        accumulate(*a, usage, seen);
+    else if (auto o = std::get_if<object_t>(&value_))
+        o->accumulate(usage, seen);
+    else if (auto sa = std::get_if<shared_array_t>(&value_))
+    {
+        if (firstVisit(sa->get(), sizeof(array_t)))
+            accumulate(**sa, usage, seen);
+    }
+    else if (auto so = std::get_if<shared_object_t>(&value_))
+    {
+        if (firstVisit(so->get(), sizeof(object_t)))
+            (*so)->accumulate(usage, seen);
+    }
+}
+
+inline void JsonValue::shrink_to_fit()
+{
+    if (auto s = std::get_if<string_t>(&value_))
+    {
+        s->shrink_to_fit();
+    }
+    else if (auto a = std::get_if<array_t>(&value_))
+    {
+        for (auto &v : *a)
+            v.shrink_to_fit();
+        a->shrink_to_fit();
+    }
+    else if (auto o = std::get_if<object_t>(&value_))
+    {
+        o->shrink_to_fit();
+    }
+    else if (auto pi = std::get_if<packed_integer_t>(&value_))
+    {
+        pi->shrink_to_fit();
+    }
+    else if (auto pf = std::get_if<packed_float_t>(&value_))
+    {
+        pf->shrink_to_fit();
+    }
+}
+
+inline bool JsonValue::numberKey(const JsonValue &v, NumberKey &key)
+{
+    if (auto i = std::get_if<number_integer_t>(&v.value_))
+        key = NumberKey::of(*i);
+    else if (auto d = std::get_if<number_float_t>(&v.value_))
+        key = NumberKey::of(*d);
+    else if (auto n = std::get_if<number_raw_t>(&v.value_))
+        key = NumberKey::of(*n);
+    else
+        return false;
+    return true;
+}
+
+inline size_t JsonValue::arraySize() const
+{
+    if (auto pi = std::get_if<packed_integer_t>(&value_))
+        return pi->size();
+    if (auto pf = std::get_if<packed_float_t>(&value_))
+        return pf->size();
+    return get<array_t>().size();
+}
+
+// Key of element i of an array, false if it is not a number.
+inline bool JsonValue::elementKey(size_t i, NumberKey &key) const
+{
+    if (auto pi = std::get_if<packed_integer_t>(&value_))
+        key = NumberKey::of((*pi)[i]);
+    else if (auto pf = std::get_if<packed_float_t>(&value_))
+        key = NumberKey::of((*pf)[i]);
+    else
+        return numberKey(get<array_t>()[i], key);
+    return true;
+}
+
+inline bool operator==(const Json &a, const Json &b)
+{
+    if (&a == &b)
+        return true;
+    if (a.size() != b.size())
+        return false;
+    for (const auto &[key, value] : a.object_)
+    {
+        auto it = b.object_.find(key);
+        if (it == b.object_.end() || !(value == it->second))
+            return false;
+    }
+    return true;
+}
+
+inline bool operator==(const JsonValue &a, const JsonValue &b)
+{
+    using V = JsonValue;
+
+    if (a.is_object() || b.is_object())
+    {
+        if (!a.is_object() || !b.is_object())
+            return false;
+        const auto &x = a.get<V::object_t>();
+        const auto &y = b.get<V::object_t>();
+        return &x == &y || x == y;
+    }
+    if (a.is_array() || b.is_array())
+    {
+        if (!a.is_array() || !b.is_array())
+            return false;
+        if (a.is_packed() || b.is_packed())
+        {
+            size_t n = a.arraySize();
+            if (n != b.arraySize())
+                return false;
+            NumberKey x, y;
+            for (size_t i = 0; i < n; ++i)
+                if (!a.elementKey(i, x) || !b.elementKey(i, y) || !(x == y))
+                    return false;
+            return true;
+        }
+        const auto &x = a.get<V::array_t>();
+        const auto &y = b.get<V::array_t>();
+        if (&x == &y)
+            return true;
+        if (x.size() != y.size())
+            return false;
+        for (size_t i = 0; i < x.size(); ++i)
+            if (!(x[i] == y[i]))
+                return false;
+        return true;
+    }
+
+    NumberKey x, y;
+    bool xn = V::numberKey(a, x);
+    bool yn = V::numberKey(b, y);
+    if (xn || yn)
+        return xn && yn && x == y;
+
+    if (a.value_.index() != b.value_.index())
+        return false;
+    if (a.is_string())
+        return a.get<V::string_t>() == b.get<V::string_t>();
+    if (a.is_boolean())
+        return a.get<V::boolean_t>() == b.get<V::boolean_t>();
+    return true;
+}
+
 inline std::ostream &operator<<(std::ostream &os, const JsonValue &json);
 
 inline std::ostream &operator<<(std::ostream &os, const Json &j)
@@ -161,14 +644,36 @@ inline std::ostream &operator<<(std::ostream &os, const JsonValue &json)
     {
         os << static_cast<JsonValue::number_float_t>(json);
     }
+    else if (json.is_raw_number())
+    {
+        os << json.get<JsonValue::number_raw_t>().raw();
+    }
     else if (json.is_string())
     {
-        os << '\"' << static_cast<JsonValue::string_t>(json) << '\"';
+        os << '\"' << json.get<JsonValue::string_t>() << '\"';
+    }
+    else if (json.is_packed())
+    {
+        auto print = [&os](auto values)
+        {
+            os << '[';
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                if (i > 0)
+                    os << ", ";
+                os << values[i];
+            }
+            os << ']';
+        };
+        if (json.is_packed<JsonValue::number_integer_t>())
+            print(json.packed<JsonValue::number_integer_t>());
+        else
+            print(json.packed<JsonValue::number_float_t>());
     }
     else if (json.is_array())
     {
         os << '[';
-        const auto &arr = static_cast<JsonValue::array_t>(json);
+        const auto &arr = json.get<JsonValue::array_t>();
         for (size_t i = 0; i < arr.size(); ++i)
         {
             if (i > 0)
@@ -179,7 +684,7 @@ inline std::ostream &operator<<(std::ostream &os, const JsonValue &json)
     }
     else if (json.is_object())
     {
-        os << static_cast<JsonValue::object_t>(json);
+        os << json.get<JsonValue::object_t>();
     }
     return os;
 }
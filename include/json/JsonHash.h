@@ -0,0 +1,184 @@
+#ifndef JSONHASH_H
+#define JSONHASH_H
+
+#include "Json.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+class JsonHashCache;
+
+// Structural hash consistent with operator==: key order does not matter and
+// numbers hash by value (see NumberKey). An object's hash is derived from the
+// wrapping sum of its entry hashes, so it can be maintained incrementally:
+// add entry(key, hash(value)) on insert, subtract it on erase, and pass the
+// sum to object(). Hashing allocates nothing unless a cache is attached.
+class JsonHash
+{
+public:
+    JsonHash() = default;
+    explicit JsonHash(JsonHashCache &cache) : cache_(&cache) {}
+
+    uint64_t operator()(const JsonValue &value) const;
+    uint64_t operator()(const Json &obj) const;
+
+    static uint64_t entry(std::string_view key, uint64_t valueHash);
+    static uint64_t object(uint64_t entrySum);
+    static uint64_t string(std::string_view s);
+    static uint64_t number(const NumberKey &key);
+
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+private:
+    JsonHashCache *cache_ = nullptr;
+
+    enum : uint64_t
+    {
+        NULL_TAG = 0x6e756c6c,
+        FALSE_TAG = 0x66616c73,
+        TRUE_TAG = 0x74727565,
+        STRING_TAG = 0x73747269,
+        ARRAY_TAG = 0x61727261,
+        OBJECT_TAG = 0x6f626a65,
+        NUMBER_TAG = 0x6e756d62
+    };
+
+    uint64_t array(const JsonValue::array_t &arr) const;
+    template <typename T>
+    static uint64_t packed(std::span<const T> values);
+    uint64_t compute(const JsonValue &value) const;
+};
+
+// Remembers the hashes of shared (copy-on-write) containers. They are
+// immutable, so a cached hash never goes stale; the cache holds a reference
+// to each container so its address cannot be reused while cached.
+class JsonHashCache
+{
+public:
+    size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+private:
+    friend class JsonHash;
+    std::unordered_map<const void *, std::pair<JsonValue, uint64_t>> entries_;
+};
+
+inline uint64_t JsonHash::string(std::string_view s)
+{
+    return mix(std::hash<std::string_view>{}(s) ^ STRING_TAG);
+}
+
+inline uint64_t JsonHash::number(const NumberKey &key)
+{
+    if (key.kind == NumberKey::INTEGER)
+        return mix(static_cast<uint64_t>(key.integer) ^ NUMBER_TAG);
+    if (key.kind == NumberKey::FLOAT)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &key.real, sizeof(bits));
+        return mix(mix(bits) ^ NUMBER_TAG);
+    }
+    return mix(string(key.text) ^ NUMBER_TAG);
+}
+
+inline uint64_t JsonHash::entry(std::string_view key, uint64_t valueHash)
+{
+    return mix(string(key) * 31 + valueHash);
+}
+
+inline uint64_t JsonHash::object(uint64_t entrySum)
+{
+    return mix(entrySum ^ OBJECT_TAG);
+}
+
+inline uint64_t JsonHash::operator()(const Json &obj) const
+{
+    uint64_t sum = 0;
+    for (const auto &kv : obj)
+        sum += entry(kv.first, (*this)(kv.second));
+    return object(sum);
+}
+
+inline uint64_t JsonHash::array(const JsonValue::array_t &arr) const
+{
+    uint64_t h = mix(ARRAY_TAG + arr.size());
+    for (const auto &v : arr)
+        h = mix(h ^ (*this)(v));
+    return h;
+}
+
+// Matches array() over the same numbers held as JsonValues.
+template <typename T>
+uint64_t JsonHash::packed(std::span<const T> values)
+{
+    uint64_t h = mix(ARRAY_TAG + values.size());
+    for (T v : values)
+        h = mix(h ^ number(NumberKey::of(v)));
+    return h;
+}
+
+inline uint64_t JsonHash::compute(const JsonValue &value) const
+{
+    if (value.is_packed<JsonValue::number_integer_t>())
+        return packed(value.packed<JsonValue::number_integer_t>());
+    if (value.is_packed<JsonValue::number_float_t>())
+        return packed(value.packed<JsonValue::number_float_t>());
+    if (value.is_object())
+        return (*this)(value.get<JsonValue::object_t>());
+    if (value.is_array())
+        return array(value.get<JsonValue::array_t>());
+    if (value.is_string())
+        return string(value.get<JsonValue::string_t>());
+    if (value.is_boolean())
+        return mix(value.get<JsonValue::boolean_t>() ? TRUE_TAG : FALSE_TAG);
+    if (value.is_integer())
+        return number(NumberKey::of(value.get<JsonValue::number_integer_t>()));
+    if (value.is_float())
+        return number(NumberKey::of(value.get<JsonValue::number_float_t>()));
+    if (value.is_raw_number())
+        return number(NumberKey::of(value.get<JsonValue::number_raw_t>()));
+    return mix(NULL_TAG);
+}
+
+inline uint64_t JsonHash::operator()(const JsonValue &value) const
+{
+    if (!cache_ || !value.is_shared())
+        return compute(value);
+
+    const void *key = value.is_object() ? static_cast<const void *>(&value.get<JsonValue::object_t>())
+                                        : static_cast<const void *>(&value.get<JsonValue::array_t>());
+    auto it = cache_->entries_.find(key);
+    if (it != cache_->entries_.end())
+        return it->second.second;
+
+    uint64_t h = compute(value);
+    cache_->entries_.emplace(key, std::make_pair(value, h));
+    return h;
+}
+
+template <>
+struct std::hash<JsonValue>
+{
+    size_t operator()(const JsonValue &value) const { return static_cast<size_t>(JsonHash{}(value)); }
+};
+
+template <>
+struct std::hash<Json>
+{
+    size_t operator()(const Json &obj) const { return static_cast<size_t>(JsonHash{}(obj)); }
+};
+
+#endif // JSONHASH_H
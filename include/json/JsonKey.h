@@ -0,0 +1,78 @@
+#ifndef JSONKEY_H
+#define JSONKEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// An object key with its hash computed up front, at compile time when the
+// key is a constant:
+//
+//   static constexpr JsonKey id{"id"};
+//   if (auto it = json.find(id); it != json.end()) ...
+//
+// Lookups with a JsonKey neither allocate nor rehash the key. The viewed
+// characters must outlive the key.
+class JsonKey
+{
+public:
+    constexpr JsonKey(const char *name) : JsonKey(std::string_view(name)) {}
+    constexpr JsonKey(const std::string &name) : JsonKey(std::string_view(name)) {}
+    constexpr JsonKey(std::string_view name) : name_(name), hash_(hash(name)) {}
+
+    constexpr std::string_view name() const { return name_; }
+    constexpr size_t hash() const { return hash_; }
+
+    // The hash used by Json objects for every key. Works on eight bytes at a
+    // time; assembling the words byte by byte keeps it usable in constant
+    // expressions and compiles to plain loads.
+    static constexpr size_t hash(std::string_view s)
+    {
+        constexpr uint64_t m = 0x9E3779B97F4A7C15ULL;
+        uint64_t h = s.size() * m;
+        size_t i = 0;
+        for (; i + 8 <= s.size(); i += 8)
+            h = mix(h ^ word(s, i, 8));
+        if (i < s.size())
+            h = mix(h ^ word(s, i, s.size() - i));
+        return static_cast<size_t>(mix(h));
+    }
+
+    friend constexpr bool operator==(const JsonKey &a, std::string_view b) { return a.name_ == b; }
+
+private:
+    std::string_view name_;
+    size_t hash_;
+
+    static constexpr uint64_t word(std::string_view s, size_t i, size_t n)
+    {
+        uint64_t w = 0;
+        for (size_t b = 0; b < n; ++b)
+            w |= static_cast<uint64_t>(static_cast<unsigned char>(s[i + b])) << (8 * b);
+        return w;
+    }
+
+    static constexpr uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ULL;
+        x ^= x >> 32;
+        return x;
+    }
+};
+
+// Transparent hasher for Json objects: std::string, std::string_view and
+// C strings hash alike, and JsonKey supplies its stored hash. Deliberately
+// not noexcept so the map keeps caching hash codes in its nodes.
+struct JsonKeyHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const { return JsonKey::hash(s); }
+    size_t operator()(const std::string &s) const { return JsonKey::hash(s); }
+    size_t operator()(const char *s) const { return JsonKey::hash(s); }
+    size_t operator()(const JsonKey &k) const { return k.hash(); }
+};
+
+#endif // JSONKEY_H
@@ -0,0 +1,232 @@
+#ifndef JSONNUMBER_H
+#define JSONNUMBER_H
+
+#include "Config.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+// 128-bit integer targets need compiler support (GCC and Clang, not MSVC).
+#if defined(__SIZEOF_INT128__)
+#define LIBJSON_INT128 1
+#endif
+
+// A JSON number kept as its original text. Conversion to binary happens on
+// access, so numbers that are only passed through are never converted and
+// are serialized byte for byte, whatever their precision. Integral targets
+// include 128-bit types where LIBJSON_INT128 is defined.
+class JsonNumber
+{
+public:
+    // Tag for text already known to be a valid JSON number (e.g. a lexer
+    // token), which skips validation.
+    static constexpr struct unchecked_t
+    {
+    } unchecked{};
+
+    explicit JsonNumber(std::string text) : text_(std::move(text))
+    {
+        if (!scan())
+            LIBJSON_THROW(std::invalid_argument("Invalid JSON number: " + text_));
+    }
+
+    JsonNumber(std::string text, unchecked_t) : text_(std::move(text)) { scan(); }
+
+    const std::string &raw() const { return text_; }
+
+    // True when the text has no fraction or exponent part.
+    bool is_integer() const { return integer_; }
+
+    template <typename T>
+    T get() const;
+
+    // Non-throwing conversion; false if the value is not representable as T.
+    template <typename T>
+    bool try_get(T &out) const { return convert(out) == std::errc(); }
+
+private:
+    std::string text_;
+    bool integer_ = true;
+
+    bool scan();
+
+    template <typename T>
+    std::errc convert(T &out) const;
+
+    // value = value * 10 -/+ digit; false on overflow.
+    template <typename T>
+    static bool accumulate(T &value, T digit, bool negative);
+};
+
+inline bool JsonNumber::scan()
+{
+    const char *p = text_.data();
+    const char *end = p + text_.size();
+
+    auto digits = [&]()
+    {
+        const char *start = p;
+        while (p < end && *p >= '0' && *p <= '9')
+            ++p;
+        return p > start;
+    };
+
+    if (p < end && *p == '-')
+        ++p;
+    if (p < end && *p == '0')
+        ++p;
+    else if (!digits())
+        return false;
+
+    if (p < end && *p == '.')
+    {
+        ++p;
+        integer_ = false;
+        if (!digits())
+            return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        integer_ = false;
+        if (p < end && (*p == '+' || *p == '-'))
+            ++p;
+        if (!digits())
+            return false;
+    }
+    return p == end;
+}
+
+template <typename T>
+T JsonNumber::get() const
+{
+    T value{};
+    std::errc ec = convert(value);
+    if (ec == std::errc::invalid_argument)
+        LIBJSON_THROW(std::invalid_argument("JSON number is not an integer: " + text_));
+    if (ec != std::errc())
+        LIBJSON_THROW(std::out_of_range("JSON number out of range: " + text_));
+    return value;
+}
+
+template <typename T>
+std::errc JsonNumber::convert(T &out) const
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        return std::from_chars(text_.data(), text_.data() + text_.size(), out).ec;
+    }
+    else
+    {
+#ifdef LIBJSON_INT128
+        static_assert(std::is_integral_v<T> || std::is_same_v<T, __int128> || std::is_same_v<T, unsigned __int128>,
+                      "Unsupported type for JsonNumber");
+#else
+        static_assert(std::is_integral_v<T>, "Unsupported type for JsonNumber");
+#endif
+        if (!integer_)
+            return std::errc::invalid_argument;
+
+        // Accumulate towards the sign of the result so the most negative
+        // value of a signed type is reachable.
+        bool negative = text_.front() == '-';
+        T value = 0;
+        for (size_t i = negative ? 1 : 0; i < text_.size(); ++i)
+        {
+            T digit = static_cast<T>(text_[i] - '0');
+            if (!accumulate(value, digit, negative))
+                return std::errc::result_out_of_range;
+        }
+        out = value;
+        return std::errc();
+    }
+}
+
+template <typename T>
+bool JsonNumber::accumulate(T &value, T digit, bool negative)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return !(__builtin_mul_overflow(value, T(10), &value) ||
+             (negative ? __builtin_sub_overflow(value, digit, &value) : __builtin_add_overflow(value, digit, &value)));
+#else
+    // Division truncates towards zero, which is the ceiling for the
+    // negative bound and the floor for the positive one.
+    if (negative)
+    {
+        if (std::is_unsigned_v<T> ? digit != 0 || value != 0
+                                  : value < (std::numeric_limits<T>::min() + digit) / 10)
+            return false;
+        value = value * 10 - digit;
+    }
+    else
+    {
+        if (value > (std::numeric_limits<T>::max() - digit) / 10)
+            return false;
+        value = value * 10 + digit;
+    }
+    return true;
+#endif
+}
+
+// Numeric identity used by equality and hashing, independent of how a number
+// is stored: integral values that fit int64 are integers (so 1, 1.0 and "1e0"
+// agree), other finite values are doubles, and anything else (integers
+// beyond 64 bits, out-of-range text) is compared by its text.
+struct NumberKey
+{
+    enum Kind : uint8_t
+    {
+        INTEGER,
+        FLOAT,
+        TEXT
+    };
+
+    Kind kind = INTEGER;
+    int64_t integer = 0;
+    double real = 0;
+    std::string_view text;
+
+    static NumberKey of(int64_t i) { return {INTEGER, i, 0, {}}; }
+    static NumberKey of(double d);
+    static NumberKey of(const JsonNumber &n);
+
+    bool operator==(const NumberKey &other) const
+    {
+        if (kind != other.kind)
+            return false;
+        if (kind == INTEGER)
+            return integer == other.integer;
+        if (kind == FLOAT)
+            return real == other.real;
+        return text == other.text;
+    }
+};
+
+inline NumberKey NumberKey::of(double d)
+{
+    // [-2^63, 2^63) is exactly representable at both ends.
+    if (d >= -9223372036854775808.0 && d < 9223372036854775808.0 && std::trunc(d) == d)
+        return of(static_cast<int64_t>(d));
+    return {FLOAT, 0, d, {}};
+}
+
+inline NumberKey NumberKey::of(const JsonNumber &n)
+{
+    int64_t i;
+    if (n.try_get(i))
+        return of(i);
+    double d;
+    if (!n.is_integer() && n.try_get(d))
+        return of(d);
+    return {TEXT, 0, 0, n.raw()};
+}
+
+#endif // JSONNUMBER_H
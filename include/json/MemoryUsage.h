@@ -0,0 +1,32 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <cstddef>
+#include <string>
+
+// Heap bytes held by a Json tree, by category. Sizes of map nodes and shared
+// control blocks are estimates for the standard library in use; allocator
+// bookkeeping is not included.
+struct MemoryUsage
+{
+    size_t keys = 0;       // object key buffers
+    size_t strings = 0;    // string value and raw number buffers
+    size_t containers = 0; // array elements and object nodes in use
+    size_t slack = 0;      // reserved but unused vector and string capacity
+    size_t overhead = 0;   // hash buckets and shared-ownership control blocks
+
+    size_t total() const { return keys + strings + containers + slack + overhead; }
+
+    // Counts the heap buffer of s, if it has one (short strings live inside
+    // the object).
+    void add_string(size_t &category, const std::string &s)
+    {
+        const char *self = reinterpret_cast<const char *>(&s);
+        if (s.data() >= self && s.data() < self + sizeof(s))
+            return;
+        category += s.size() + 1;
+        slack += s.capacity() - s.size();
+    }
+};
+
+#endif // MEMORYUSAGE_H
@@ -0,0 +1,126 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+// Byte classification for the scalar lexer: one table lookup instead of
+// chained comparisons or locale-dependent <cctype> calls, plus SWAR loops
+// that consume whitespace and digit runs eight bytes at a time without any
+// intrinsics.
+class CharClass
+{
+public:
+    static constexpr uint8_t WHITESPACE = 1 << 0;
+    static constexpr uint8_t DIGIT = 1 << 1;
+    static constexpr uint8_t ALPHA = 1 << 2;
+    // Bytes that may appear in a number token: digits, '-', '+', '.', 'e', 'E'.
+    static constexpr uint8_t NUMBER = 1 << 3;
+
+    static bool is(char c, uint8_t cls) { return table[static_cast<unsigned char>(c)] & cls; }
+
+    // Index of the first byte in [i, n) that is not JSON whitespace, or n.
+    static size_t skipWhitespace(const char *p, size_t i, size_t n);
+    // Index of the first byte in [i, n) that is not an ASCII digit, or n.
+    static size_t skipDigits(const char *p, size_t i, size_t n);
+
+    // Compares four bytes at p with a literal as one word.
+    static bool equals4(const char *p, const char (&word)[5])
+    {
+        uint32_t a, b;
+        std::memcpy(&a, p, 4);
+        std::memcpy(&b, word, 4);
+        return a == b;
+    }
+
+private:
+    static constexpr std::array<uint8_t, 256> buildTable();
+    static const std::array<uint8_t, 256> table;
+
+    static constexpr uint64_t ones = 0x0101010101010101ULL;
+    static constexpr uint64_t highs = 0x8080808080808080ULL;
+
+    // High bit of each byte set exactly where that byte of w is zero; unlike
+    // the shorter (w - ones) & ~w form, no borrow leaks into other bytes.
+    static uint64_t zeroBytes(uint64_t w)
+    {
+        uint64_t low = (w & ~highs) + ~highs;
+        return ~(low | w | ~highs);
+    }
+
+    static uint64_t load(const char *p)
+    {
+        uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    // Offset of the first byte flagged in mask (high bits only), in memory order.
+    static size_t firstByte(uint64_t mask)
+    {
+        if constexpr (std::endian::native == std::endian::little)
+            return static_cast<size_t>(std::countr_zero(mask)) / 8;
+        else
+            return static_cast<size_t>(std::countl_zero(mask)) / 8;
+    }
+};
+
+constexpr std::array<uint8_t, 256> CharClass::buildTable()
+{
+    std::array<uint8_t, 256> t{};
+    t[' '] = t['\t'] = t['\n'] = t['\r'] = WHITESPACE;
+    for (int c = '0'; c <= '9'; ++c)
+        t[c] = DIGIT | NUMBER;
+    for (int c = 'a'; c <= 'z'; ++c)
+        t[c] = ALPHA;
+    for (int c = 'A'; c <= 'Z'; ++c)
+        t[c] = ALPHA;
+    t['e'] |= NUMBER;
+    t['E'] |= NUMBER;
+    t['-'] = t['+'] = t['.'] = NUMBER;
+    return t;
+}
+
+inline const std::array<uint8_t, 256> CharClass::table = CharClass::buildTable();
+
+inline size_t CharClass::skipWhitespace(const char *p, size_t i, size_t n)
+{
+    // Most tokens are preceded by no or a single space; skip the word setup.
+    while (i < n && is(p[i], WHITESPACE))
+    {
+        if (++i + 8 > n || !is(p[i], WHITESPACE))
+            continue;
+        for (; i + 8 <= n; i += 8)
+        {
+            uint64_t w = load(p + i);
+            uint64_t ws = zeroBytes(w ^ (ones * ' ')) | zeroBytes(w ^ (ones * '\t')) |
+                          zeroBytes(w ^ (ones * '\n')) | zeroBytes(w ^ (ones * '\r'));
+            uint64_t other = ~ws & highs;
+            if (other)
+                return i + firstByte(other);
+        }
+    }
+    return i;
+}
+
+inline size_t CharClass::skipDigits(const char *p, size_t i, size_t n)
+{
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w = load(p + i);
+        // A digit has high nibble 3 and low nibble below 10; adding 6 to the
+        // low nibble carries into bit 4 exactly when it is 10 or more.
+        uint64_t highNibble = zeroBytes((w & (ones * 0xF0)) ^ (ones * 0x30));
+        uint64_t lowTooBig = (((w & (ones * 0x0F)) + ones * 0x06) << 3) & highs;
+        uint64_t other = ~(highNibble & ~lowTooBig) & highs;
+        if (other)
+            return i + firstByte(other);
+    }
+    while (i < n && is(p[i], DIGIT))
+        ++i;
+    return i;
+}
+
+#endif // CHARCLASS_H
@@ -1,21 +1,41 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include "CharClass.h"
 #include "Token.h"
+#include "Utf8.h"
+#include "parser/ParseError.h"
+#include "parser/ParseLimits.h"
+#include "parser/ParseOptions.h"
 
+#include <chrono>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-class Lexer
+template <typename Options>
+class BasicLexer
 {
 public:
-    Lexer(std::string_view input) : input_(input), pos_(0) {}
+    BasicLexer() : pos_(0) {}
+    BasicLexer(std::string_view input) : input_(input), pos_(0) {}
 
     std::string input() const { return input_; }
 
+    void reset(std::string_view input);
+
     Token nextToken();
+    void nextToken(Token &t);
 
     std::vector<Token> tokenise();
+    void tokenise(std::vector<Token> &tokens);
+    // Stops at the first token that breaks max_elements or
+    // max_string_length, or once the deadline has passed, so an oversized
+    // input never reaches its full token count. On failure the vector ends
+    // at the offending token and error holds the cause.
+    bool tokenise(std::vector<Token> &tokens, const ParseLimits &limits,
+                  std::chrono::steady_clock::time_point deadline, ParseError &error);
 
 private:
     std::string input_;
@@ -26,70 +46,161 @@ private:
     char get() { return pos_ < input_.size() ? input_[pos_++] : '\0'; }
     bool eof() const { return pos_ >= input_.size(); }
 
-    Token parseString();
-    Token parseNumber();
-    Token parseLiteral();
+    static void set(Token &t, Token::Type type, size_t pos)
+    {
+        t.type = type;
+        t.pos = pos;
+    }
+
+    void parseString(Token &t);
+    bool parseUnicodeEscape(std::string &result);
+    void parseNumber(Token &t);
+    void parseLiteral(Token &t);
 };
 
-inline std::vector<Token> Lexer::tokenise()
+template <typename Options>
+void BasicLexer<Options>::reset(std::string_view input)
+{
+    input_.assign(input);
+    pos_ = 0;
+}
+
+template <typename Options>
+std::vector<Token> BasicLexer<Options>::tokenise()
 {
     std::vector<Token> tokens;
+    tokenise(tokens);
+    return tokens;
+}
+
+// Reuses the Token objects (and their lexeme buffers) already in the vector.
+template <typename Options>
+void BasicLexer<Options>::tokenise(std::vector<Token> &tokens)
+{
+    size_t n = 0;
     for (;;)
     {
-        Token t = nextToken();
-        tokens.push_back(t);
+        if (n == tokens.size())
+            tokens.emplace_back(Token::EOFTOKEN);
+        Token &t = tokens[n++];
+        nextToken(t);
         if (t.type == Token::EOFTOKEN)
             break;
     }
-    return tokens;
+    tokens.erase(tokens.begin() + n, tokens.end());
 }
 
-inline void Lexer::skipWhitespace()
+template <typename Options>
+bool BasicLexer<Options>::tokenise(std::vector<Token> &tokens, const ParseLimits &limits,
+                                   std::chrono::steady_clock::time_point deadline, ParseError &error)
 {
-    while (!eof())
+    size_t n = 0;
+    size_t elements = 0;
+    bool ok = true;
+    for (;;)
     {
-        char c = peek();
-        if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
-            get();
-        else
+        if (n == tokens.size())
+            tokens.emplace_back(Token::EOFTOKEN);
+        Token &t = tokens[n++];
+        nextToken(t);
+
+        switch (t.type)
+        {
+        case Token::STRING:
+            ++elements;
+            if (t.lexeme.size() > limits.max_string_length)
+            {
+                error = {ParseError::STRING_TOO_LONG, t.pos};
+                ok = false;
+            }
+            break;
+        case Token::COLON:
+            // The string before it was a key, not a value.
+            if (elements > 0)
+                --elements;
+            break;
+        case Token::LBRACE:
+        case Token::LBRACKET:
+        case Token::INTEGER:
+        case Token::FLOAT:
+        case Token::TRUE:
+        case Token::FALSE:
+        case Token::NULLTOKEN:
+            ++elements;
+            break;
+        default:
+            break;
+        }
+
+        // A string may still turn out to be a key, so its count is checked
+        // at the next token.
+        if (ok && t.type != Token::STRING && elements > limits.max_elements)
+        {
+            error = {ParseError::TOO_MANY_ELEMENTS, t.pos};
+            ok = false;
+        }
+        if (ok && n % ParseLimits::deadline_interval == 0 && std::chrono::steady_clock::now() > deadline)
+        {
+            error = {ParseError::DEADLINE_EXCEEDED, t.pos};
+            ok = false;
+        }
+        if (!ok || t.type == Token::EOFTOKEN)
             break;
     }
+    tokens.erase(tokens.begin() + n, tokens.end());
+    return ok;
 }
 
-inline Token Lexer::nextToken()
+template <typename Options>
+void BasicLexer<Options>::skipWhitespace()
+{
+    pos_ = CharClass::skipWhitespace(input_.data(), pos_, input_.size());
+}
+
+template <typename Options>
+Token BasicLexer<Options>::nextToken()
+{
+    Token t(Token::EOFTOKEN);
+    nextToken(t);
+    return t;
+}
+
+template <typename Options>
+void BasicLexer<Options>::nextToken(Token &t)
 {
     skipWhitespace();
+    t.lexeme.clear();
     if (eof())
-        return Token(Token::EOFTOKEN, "", pos_);
+        return set(t, Token::EOFTOKEN, pos_);
 
     char c = peek();
 
     switch (c)
     {
     case '{':
-        get();
-        return Token(Token::LBRACE, "{", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::LBRACE, pos_ - 1);
     case '}':
-        get();
-        return Token(Token::RBRACE, "}", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::RBRACE, pos_ - 1);
     case '[':
-        get();
-        return Token(Token::LBRACKET, "[", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::LBRACKET, pos_ - 1);
     case ']':
-        get();
-        return Token(Token::RBRACKET, "]", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::RBRACKET, pos_ - 1);
     case ',':
-        get();
-        return Token(Token::COMMA, ",", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::COMMA, pos_ - 1);
     case ':':
-        get();
-        return Token(Token::COLON, ":", pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::COLON, pos_ - 1);
     case '"':
-        return parseString();
+        return parseString(t);
     case 't':
     case 'f':
     case 'n':
-        return parseLiteral();
+        return parseLiteral(t);
     case '-':
     case '0':
     case '1':
@@ -101,131 +212,200 @@ inline Token Lexer::nextToken()
     case '7':
     case '8':
     case '9':
-        return parseNumber();
+        return parseNumber(t);
     default:
-        get();
-        return Token(Token::INVALID, std::string(1, c), pos_ - 1);
+        t.lexeme += get();
+        return set(t, Token::INVALID, pos_ - 1);
     }
 }
 
-inline Token Lexer::parseString()
+// Copies runs of plain characters in bulk, validating any run that contains
+// non-ASCII bytes as UTF-8, and decodes escapes including \uXXXX and
+// surrogate pairs. Malformed UTF-8 or escapes and unescaped control
+// characters yield an INVALID token.
+template <typename Options>
+void BasicLexer<Options>::parseString(Token &t)
 {
-    std::string result;
+    std::string &result = t.lexeme;
+    const char *p = input_.data();
+    const size_t n = input_.size();
+    const size_t begin = pos_;
     get();
 
     while (!eof())
     {
-        char c = get();
-        if (c == '"')
-            return Token(Token::STRING, result, pos_);
-        if (c == '\\')
+        bool ascii = true;
+        size_t start = pos_;
+        pos_ = Utf8::findSpecial(p, pos_, n, ascii);
+        if constexpr (Options::validate_utf8)
         {
-            if (eof())
-                break;
-            char esc = get();
-            switch (esc)
-            {
-            case '"':
-                result += '"';
-                break;
-            case '\\':
-                result += '\\';
-                break;
-            case '/':
-                result += '/';
-                break;
-            case 'b':
-                result += '\b';
-                break;
-            case 'f':
-                result += '\f';
-                break;
-            case 'n':
-                result += '\n';
-                break;
-            case 'r':
-                result += '\r';
-                break;
-            case 't':
-                result += '\t';
-                break;
-            default:
-                result += esc;
-                break;
-            }
+            if (!ascii && !Utf8::validate(p + start, pos_ - start))
+                return set(t, Token::INVALID, pos_);
         }
-        else
+        result.append(p + start, pos_ - start);
+
+        if (eof())
+            break;
+
+        char c = get();
+        if (c == '"')
+            return set(t, Token::STRING, begin);
+        if (c != '\\')
+            return set(t, Token::INVALID, pos_ - 1);
+
+        if (eof())
+            break;
+        char esc = get();
+        switch (esc)
         {
-            result += c;
+        case '"':
+            result += '"';
+            break;
+        case '\\':
+            result += '\\';
+            break;
+        case '/':
+            result += '/';
+            break;
+        case 'b':
+            result += '\b';
+            break;
+        case 'f':
+            result += '\f';
+            break;
+        case 'n':
+            result += '\n';
+            break;
+        case 'r':
+            result += '\r';
+            break;
+        case 't':
+            result += '\t';
+            break;
+        case 'u':
+            if (!parseUnicodeEscape(result))
+                return set(t, Token::INVALID, pos_);
+            break;
+        default:
+            return set(t, Token::INVALID, pos_);
         }
     }
 
-    return Token(Token::INVALID, result, pos_);
+    set(t, Token::INVALID, pos_);
 }
 
-inline Token Lexer::parseNumber()
+template <typename Options>
+bool BasicLexer<Options>::parseUnicodeEscape(std::string &result)
 {
-    std::string result;
+    if (pos_ + 4 > input_.size())
+        return false;
+    int32_t cp = Utf8::decodeHex4(input_.data() + pos_);
+    if (cp < 0)
+        return false;
+    pos_ += 4;
 
-    if (peek() == '-')
-        result += get();
-
-    bool hasDigits = false;
+    if (cp >= 0xDC00 && cp <= 0xDFFF)
+        return false;
 
-    while (!eof() && std::isdigit(peek()))
+    if (cp >= 0xD800 && cp <= 0xDBFF)
     {
-        result += get();
-        hasDigits = true;
+        if (pos_ + 6 > input_.size() || input_[pos_] != '\\' || input_[pos_ + 1] != 'u')
+            return false;
+        int32_t low = Utf8::decodeHex4(input_.data() + pos_ + 2);
+        if (low < 0xDC00 || low > 0xDFFF)
+            return false;
+        pos_ += 6;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
     }
 
+    Utf8::append(result, static_cast<uint32_t>(cp));
+    return true;
+}
+
+// Scans digit runs with CharClass and copies the whole token once at the end.
+template <typename Options>
+void BasicLexer<Options>::parseNumber(Token &t)
+{
+    const char *p = input_.data();
+    const size_t n = input_.size();
+    const size_t start = pos_;
+
+    if (peek() == '-')
+        ++pos_;
+
+    size_t digits = pos_;
+    pos_ = CharClass::skipDigits(p, pos_, n);
+    bool hasDigits = pos_ > digits;
+
     bool isFloat = false;
 
-    if (!eof() && peek() == '.')
+    if (peek() == '.')
     {
         isFloat = true;
-        result += get();
-        if (eof() || !std::isdigit(peek()))
-            return Token(Token::INVALID, result, pos_);
-        while (!eof() && std::isdigit(peek()))
-            result += get();
+        digits = ++pos_;
+        pos_ = CharClass::skipDigits(p, pos_, n);
+        if (pos_ == digits)
+            return set(t, Token::INVALID, pos_);
     }
 
-    if (!eof() && (peek() == 'e' || peek() == 'E'))
+    if (peek() == 'e' || peek() == 'E')
     {
         isFloat = true;
-        result += get();
-        if (!eof() && (peek() == '+' || peek() == '-'))
-            result += get();
-        if (eof() || !std::isdigit(peek()))
-            return Token(Token::INVALID, result, pos_);
-        while (!eof() && std::isdigit(peek()))
-            result += get();
+        ++pos_;
+        if (peek() == '+' || peek() == '-')
+            ++pos_;
+        digits = pos_;
+        pos_ = CharClass::skipDigits(p, pos_, n);
+        if (pos_ == digits)
+            return set(t, Token::INVALID, pos_);
     }
 
     if (!hasDigits)
-        return Token(Token::INVALID, result, pos_);
+        return set(t, Token::INVALID, pos_);
 
-    return isFloat
-               ? Token(Token::FLOAT, result, pos_)
-               : Token(Token::INTEGER, result, pos_);
+    t.lexeme.assign(p + start, pos_ - start);
+    set(t, isFloat ? Token::FLOAT : Token::INTEGER, start);
 }
 
-inline Token Lexer::parseLiteral()
+// Matches true/false/null with one four-byte compare ("false" is 'f' followed
+// by "alse"); a literal running on into further letters is invalid.
+template <typename Options>
+void BasicLexer<Options>::parseLiteral(Token &t)
 {
-    size_t start = pos_;
-    std::string lexeme;
+    const char *p = input_.data() + pos_;
+    const size_t left = input_.size() - pos_;
+    const size_t start = pos_;
 
-    while (!eof() && std::isalpha(peek()))
-        lexeme += get();
+    Token::Type type = Token::INVALID;
+    size_t len = 0;
+    if (left >= 4 && CharClass::equals4(p, "true"))
+    {
+        type = Token::TRUE;
+        len = 4;
+    }
+    else if (left >= 5 && p[0] == 'f' && CharClass::equals4(p + 1, "alse"))
+    {
+        type = Token::FALSE;
+        len = 5;
+    }
+    else if (left >= 4 && CharClass::equals4(p, "null"))
+    {
+        type = Token::NULLTOKEN;
+        len = 4;
+    }
 
-    if (lexeme == "true")
-        return Token(Token::TRUE, lexeme, start);
-    if (lexeme == "false")
-        return Token(Token::FALSE, lexeme, start);
-    if (lexeme == "null")
-        return Token(Token::NULLTOKEN, lexeme, start);
+    if (len == 0 || (len < left && CharClass::is(p[len], CharClass::ALPHA)))
+    {
+        while (!eof() && CharClass::is(peek(), CharClass::ALPHA))
+            t.lexeme += get();
+        return set(t, Token::INVALID, start);
+    }
 
-    return Token(Token::INVALID, lexeme, start);
+    pos_ += len;
+    t.lexeme.assign(p, len);
+    set(t, type, start);
 }
 
+using Lexer = BasicLexer<DefaultParseOptions>;
+
 #endif // LEXER_H
\ No newline at end of file
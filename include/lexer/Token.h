@@ -2,6 +2,7 @@
 #define TOKEN_H
 
 #include <string>
+#include <utility>
 
 class Token
 {
@@ -30,7 +31,7 @@ public:
     std::string lexeme;
     size_t pos;
 
-    Token(Type type_, std::string lexeme_ = "", size_t pos_ = 0) : type(type_), lexeme(lexeme_), pos(pos_) {}
+    Token(Type type_, std::string lexeme_ = "", size_t pos_ = 0) : type(type_), lexeme(std::move(lexeme_)), pos(pos_) {}
 };
 
 #endif // TOKEN_H
\ No newline at end of file
@@ -0,0 +1,418 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(LIBJSON_DISPATCH) && !defined(LIBJSON_KERNEL_NAMESPACE)
+#include "dispatch/Dispatch.h"
+#endif
+
+// The compiled library builds this header once per instruction set, each
+// copy in its own namespace so the variants never collide at link time.
+#if defined(LIBJSON_KERNEL_NAMESPACE)
+namespace LIBJSON_KERNEL_NAMESPACE
+{
+#endif
+
+class Utf8
+{
+public:
+    // Returns the index of the first '"', '\' or control character (< 0x20)
+    // in [i, n), or n. Clears `ascii` if a byte >= 0x80 occurs before that
+    // index.
+    static size_t findSpecial(const char *p, size_t i, size_t n, bool &ascii);
+
+    // Vectorised only when compiled with -mssse3 or -mavx2; plain x86-64
+    // (SSE2) builds use validateScalar unless linked against libjson_compiled,
+    // which selects an SSSE3/AVX2 kernel at load time.
+    static bool validate(const char *p, size_t n);
+
+    // Decodes four hex digits; returns a negative value on a non-hex digit.
+    static int32_t decodeHex4(const char *p);
+
+    static void append(std::string &out, uint32_t cp);
+
+    static bool validateScalar(const char *p, size_t n);
+#if defined(__SSSE3__)
+    static bool validateSsse3(const char *p, size_t n);
+#endif
+#if defined(__AVX2__)
+    static bool validateAvx2(const char *p, size_t n);
+#endif
+
+private:
+    static constexpr std::array<int32_t, 256> buildHexTable();
+    static const std::array<int32_t, 256> hex;
+
+    // Error classes of the range-lookup validator (Keiser & Lemire).
+    static constexpr uint8_t TOO_SHORT = 1 << 0;
+    static constexpr uint8_t TOO_LONG = 1 << 1;
+    static constexpr uint8_t OVERLONG_3 = 1 << 2;
+    static constexpr uint8_t TOO_LARGE = 1 << 3;
+    static constexpr uint8_t SURROGATE = 1 << 4;
+    static constexpr uint8_t OVERLONG_2 = 1 << 5;
+    static constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+    static constexpr uint8_t OVERLONG_4 = 1 << 6;
+    static constexpr uint8_t TWO_CONTS = 1 << 7;
+    static constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    static constexpr uint8_t byte1High[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+    static constexpr uint8_t byte1Low[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+    static constexpr uint8_t byte2High[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+};
+
+constexpr std::array<int32_t, 256> Utf8::buildHexTable()
+{
+    std::array<int32_t, 256> t{};
+    for (auto &v : t)
+        v = -1;
+    for (int c = '0'; c <= '9'; ++c)
+        t[c] = c - '0';
+    for (int c = 'a'; c <= 'f'; ++c)
+        t[c] = c - 'a' + 10;
+    for (int c = 'A'; c <= 'F'; ++c)
+        t[c] = c - 'A' + 10;
+    return t;
+}
+
+inline const std::array<int32_t, 256> Utf8::hex = Utf8::buildHexTable();
+
+inline int32_t Utf8::decodeHex4(const char *p)
+{
+    const auto *u = reinterpret_cast<const unsigned char *>(p);
+    return (hex[u[0]] << 12) | (hex[u[1]] << 8) | (hex[u[2]] << 4) | hex[u[3]];
+}
+
+inline void Utf8::append(std::string &out, uint32_t cp)
+{
+    char buf[4];
+    size_t len;
+    if (cp < 0x80)
+    {
+        buf[0] = static_cast<char>(cp);
+        len = 1;
+    }
+    else if (cp < 0x800)
+    {
+        buf[0] = static_cast<char>(0xC0 | (cp >> 6));
+        buf[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        len = 2;
+    }
+    else if (cp < 0x10000)
+    {
+        buf[0] = static_cast<char>(0xE0 | (cp >> 12));
+        buf[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        buf[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        len = 3;
+    }
+    else
+    {
+        buf[0] = static_cast<char>(0xF0 | (cp >> 18));
+        buf[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        buf[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        buf[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+    out.append(buf, len);
+}
+
+inline size_t Utf8::findSpecial(const char *p, size_t i, size_t n, bool &ascii)
+{
+#if defined(LIBJSON_DISPATCH) && !defined(LIBJSON_KERNEL_NAMESPACE)
+    return Dispatch::kernels().findSpecial(p, i, n, ascii);
+#else
+#if defined(__AVX512BW__)
+    const __m512i quote64 = _mm512_set1_epi8('"');
+    const __m512i backslash64 = _mm512_set1_epi8('\\');
+    const __m512i space64 = _mm512_set1_epi8(0x20);
+    for (; i + 64 <= n; i += 64)
+    {
+        __m512i v = _mm512_loadu_si512(p + i);
+        uint64_t special = _mm512_cmpeq_epi8_mask(v, quote64) | _mm512_cmpeq_epi8_mask(v, backslash64) |
+                           _mm512_cmplt_epu8_mask(v, space64);
+        uint64_t high = _mm512_movepi8_mask(v);
+        if (special)
+        {
+            if (high & (special - 1) & ~special)
+                ascii = false;
+            return i + std::countr_zero(special);
+        }
+        if (high)
+            ascii = false;
+    }
+#endif
+#if defined(__AVX2__)
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i control32 = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, control32), v);
+        uint32_t special = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, backslash32)), control)));
+        uint32_t high = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+        if (special)
+        {
+            if (high & (special - 1) & ~special)
+                ascii = false;
+            return i + std::countr_zero(special);
+        }
+        if (high)
+            ascii = false;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i backslash16 = _mm_set1_epi8('\\');
+    const __m128i control16 = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, control16), v);
+        uint32_t special = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote16), _mm_cmpeq_epi8(v, backslash16)), control)));
+        uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(v));
+        if (special)
+        {
+            if (high & (special - 1) & ~special)
+                ascii = false;
+            return i + std::countr_zero(special);
+        }
+        if (high)
+            ascii = false;
+    }
+#else
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    constexpr uint64_t highs = 0x8080808080808080ULL;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        uint64_t quote = w ^ (ones * '"');
+        uint64_t backslash = w ^ (ones * '\\');
+        uint64_t control = (w - ones * 0x20) & ~w;
+        if ((((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | control) & highs)
+            break;
+        if (w & highs)
+            ascii = false;
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        char c = p[i];
+        if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20)
+            return i;
+        if (static_cast<unsigned char>(c) >= 0x80)
+            ascii = false;
+    }
+    return n;
+#endif
+}
+
+inline bool Utf8::validateScalar(const char *p, size_t n)
+{
+    const auto *u = reinterpret_cast<const unsigned char *>(p);
+    size_t i = 0;
+    while (i < n)
+    {
+        if (i + 8 <= n)
+        {
+            uint64_t w;
+            std::memcpy(&w, u + i, sizeof(w));
+            if ((w & 0x8080808080808080ULL) == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        unsigned char c = u[i];
+        if (c < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t len;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF)
+            len = 2;
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            len = 3;
+            if (c == 0xE0)
+                lo = 0xA0;
+            else if (c == 0xED)
+                hi = 0x9F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            len = 4;
+            if (c == 0xF0)
+                lo = 0x90;
+            else if (c == 0xF4)
+                hi = 0x8F;
+        }
+        else
+            return false;
+
+        if (i + len > n || u[i + 1] < lo || u[i + 1] > hi)
+            return false;
+        for (size_t k = 2; k < len; ++k)
+            if ((u[i + k] & 0xC0) != 0x80)
+                return false;
+        i += len;
+    }
+    return true;
+}
+
+#if defined(__SSSE3__)
+
+inline bool Utf8::validateSsse3(const char *p, size_t n)
+{
+    const __m128i t1h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte1High));
+    const __m128i t1l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte1Low));
+    const __m128i t2h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte2High));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    __m128i prev = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+
+    auto check = [&](__m128i input)
+    {
+        __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+        __m128i sc = _mm_and_si128(
+            _mm_and_si128(_mm_shuffle_epi8(t1h, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                          _mm_shuffle_epi8(t1l, _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(t2h, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+
+        __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+        __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+                                      _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80))));
+        __m128i must23_80 = _mm_and_si128(must23, _mm_set1_epi8(static_cast<char>(0x80)));
+        error = _mm_or_si128(error, _mm_xor_si128(must23_80, sc));
+        prev = input;
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        check(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)));
+    if (i < n)
+    {
+        alignas(16) char tail[16] = {};
+        std::memcpy(tail, p + i, n - i);
+        check(_mm_load_si128(reinterpret_cast<const __m128i *>(tail)));
+    }
+    check(_mm_setzero_si128());
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline bool Utf8::validateAvx2(const char *p, size_t n)
+{
+    const __m256i t1h = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte1High)));
+    const __m256i t1l = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte1Low)));
+    const __m256i t2h = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte2High)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    __m256i prev = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+
+    auto check = [&](__m256i input)
+    {
+        __m256i carried = _mm256_permute2x128_si256(prev, input, 0x21);
+        __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+        __m256i sc = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(t1h, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                             _mm256_shuffle_epi8(t1l, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(t2h, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+
+        __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+        __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+        __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+                                         _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80))));
+        __m256i must23_80 = _mm256_and_si256(must23, _mm256_set1_epi8(static_cast<char>(0x80)));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must23_80, sc));
+        prev = input;
+    };
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        check(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+    if (i < n)
+    {
+        alignas(32) char tail[32] = {};
+        std::memcpy(tail, p + i, n - i);
+        check(_mm256_load_si256(reinterpret_cast<const __m256i *>(tail)));
+    }
+    check(_mm256_setzero_si256());
+
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+#endif
+
+inline bool Utf8::validate(const char *p, size_t n)
+{
+#if defined(LIBJSON_DISPATCH) && !defined(LIBJSON_KERNEL_NAMESPACE)
+    return Dispatch::kernels().validateUtf8(p, n);
+#elif defined(__AVX2__)
+    return validateAvx2(p, n);
+#elif defined(__SSSE3__)
+    return validateSsse3(p, n);
+#else
+    return validateScalar(p, n);
+#endif
+}
+
+#if defined(LIBJSON_KERNEL_NAMESPACE)
+} // namespace LIBJSON_KERNEL_NAMESPACE
+#endif
+
+#endif // UTF8_H
@@ -0,0 +1,71 @@
+#ifndef PARSEERROR_H
+#define PARSEERROR_H
+
+#include <cstddef>
+#include <string>
+
+// Why and where (byte offset into the input) a parse failed.
+struct ParseError
+{
+    enum Code
+    {
+        INVALID_TOKEN,
+        UNEXPECTED_TOKEN,
+        UNEXPECTED_END,
+        ROOT_NOT_OBJECT,
+        DEPTH_EXCEEDED,
+        NUMBER_OUT_OF_RANGE,
+        DUPLICATE_KEY,
+        // ParseLimits budgets.
+        INPUT_TOO_LARGE,
+        STRING_TOO_LONG,
+        TOO_MANY_ELEMENTS,
+        MEMORY_LIMIT_EXCEEDED,
+        DEADLINE_EXCEEDED
+    };
+
+    Code code;
+    size_t offset;
+
+    const char *message() const;
+    std::string describe() const;
+};
+
+inline const char *ParseError::message() const
+{
+    switch (code)
+    {
+    case INVALID_TOKEN:
+        return "Invalid token";
+    case UNEXPECTED_TOKEN:
+        return "Unexpected token";
+    case UNEXPECTED_END:
+        return "Unexpected end of input";
+    case ROOT_NOT_OBJECT:
+        return "Root element is not an object";
+    case DEPTH_EXCEEDED:
+        return "Maximum nesting depth exceeded";
+    case NUMBER_OUT_OF_RANGE:
+        return "Number out of range";
+    case DUPLICATE_KEY:
+        return "Duplicate key";
+    case INPUT_TOO_LARGE:
+        return "Input size limit exceeded";
+    case STRING_TOO_LONG:
+        return "String length limit exceeded";
+    case TOO_MANY_ELEMENTS:
+        return "Element count limit exceeded";
+    case MEMORY_LIMIT_EXCEEDED:
+        return "Memory limit exceeded";
+    case DEADLINE_EXCEEDED:
+        return "Parse deadline exceeded";
+    }
+    return "Unknown error";
+}
+
+inline std::string ParseError::describe() const
+{
+    return "Invalid JSON: " + std::string(message()) + " at offset " + std::to_string(offset);
+}
+
+#endif // PARSEERROR_H
@@ -0,0 +1,30 @@
+#ifndef PARSELIMITS_H
+#define PARSELIMITS_H
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+// Runtime resource budget for a single parse (see BasicParser::setLimits).
+// Exceeding one ends the parse with the matching ParseError code. Nesting
+// depth is bounded separately by BasicParser::maxDepth().
+struct ParseLimits
+{
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+    // Tokens or values between two checks of the clock.
+    static constexpr size_t deadline_interval = 4096;
+
+    size_t max_input_bytes = unlimited;
+    // Decoded length of any one string, keys included.
+    size_t max_string_length = unlimited;
+    // Values of any kind, containers included.
+    size_t max_elements = unlimited;
+    // Estimated size of the document being built: value slots, string and
+    // key contents and per-member overhead.
+    size_t max_allocated_bytes = unlimited;
+    // Wall time from the start of the parse; zero means none. Checked
+    // every few thousand tokens, so the overrun is bounded but not zero.
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds::zero();
+};
+
+#endif // PARSELIMITS_H
@@ -0,0 +1,51 @@
+#ifndef PARSEOPTIONS_H
+#define PARSEOPTIONS_H
+
+#include <cstddef>
+
+// Compile-time configuration of the BasicLexer/BasicParser pipeline. Each
+// option removes or adds code paths in the instantiation rather than being
+// checked per token. Custom policies derive from one of these and shadow the
+// members they change:
+//
+//   struct MyOptions : DefaultParseOptions
+//   {
+//       static constexpr bool lazy_numbers = true;
+//   };
+struct DefaultParseOptions
+{
+    // Later duplicates overwrite earlier ones when allowed; otherwise the
+    // parse fails with ParseError::DUPLICATE_KEY.
+    static constexpr bool allow_duplicate_keys = true;
+    // Store integer tokens as number_float_t.
+    static constexpr bool integers_as_double = false;
+    // Check string contents are well-formed UTF-8 while lexing.
+    static constexpr bool validate_utf8 = true;
+    // Initial value of maxDepth().
+    static constexpr size_t max_depth = 1024;
+    // Skip the separate validation pass and the grammar checks while
+    // building. Malformed input still cannot cause undefined behaviour but
+    // may be accepted or produce a partial document.
+    static constexpr bool trusted_input = false;
+    // Store numbers as JsonValue::number_raw_t (the number mode is fixed
+    // to RAW).
+    static constexpr bool lazy_numbers = false;
+    // Initial value of packArrays().
+    static constexpr bool pack_arrays = false;
+};
+
+// Public-facing input: everything checked, duplicate keys rejected.
+struct StrictParseOptions : DefaultParseOptions
+{
+    static constexpr bool allow_duplicate_keys = false;
+    static constexpr size_t max_depth = 256;
+};
+
+// Internally produced input that is known to be well-formed.
+struct TrustedParseOptions : DefaultParseOptions
+{
+    static constexpr bool validate_utf8 = false;
+    static constexpr bool trusted_input = true;
+};
+
+#endif // PARSEOPTIONS_H
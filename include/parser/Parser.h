@@ -1,110 +1,278 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "lexer/CharClass.h"
+#include "lexer/Lexer.h"
 #include "lexer/Token.h"
+#include "lexer/Utf8.h"
+#include "json/Config.h"
 #include "json/Json.h"
-
+#include "parser/ParseError.h"
+#include "parser/ParseLimits.h"
+#include "parser/ParseOptions.h"
+#include "parser/Projection.h"
+
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <expected>
+#include <optional>
+#include <system_error>
 #include <vector>
-#include <stack>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <variant>
 
-class Parser
+// The parsing pipeline, configured at compile time by an options policy (see
+// ParseOptions.h). Parser is the default configuration.
+template <typename Options>
+class BasicParser
 {
 public:
-    Parser(std::vector<Token> tokens) : tokens_(tokens), pos_(0) {}
+    using options_type = Options;
+
+    BasicParser() : pos_(0) {}
+    BasicParser(std::vector<Token> tokens) : tokens_(std::move(tokens)), pos_(0) {}
 
-    std::vector<Token> tokens() const { return tokens_; }
+    const std::vector<Token> &tokens() const { return tokens_; }
 
+    // Builds the document from tokens(), copying strings out of them; the
+    // buffer is left intact, so this can be called again.
     Json buildJson();
+    // Like buildJson(), but moves strings out of the token buffer instead of
+    // copying them. The buffer is spent afterwards, as it is after parse():
+    // a further buildJson() or takeJson() throws std::logic_error until the
+    // next parse refills it.
+    Json takeJson();
+
+    Json parse(std::string_view input);
+    Json parse(std::string_view input, const Projection &projection);
+    std::expected<Json, ParseError> tryParse(std::string_view input);
+    // Parses any JSON value, not only an object; throws like parse().
+    JsonValue parseValue(std::string_view input);
 
     bool validate();
 
+    // Cause and offset of the last failed validate(), buildJson() or parse.
+    const ParseError &error() const { return error_; }
+
+    static constexpr size_t default_max_depth = Options::max_depth;
+
+    size_t maxDepth() const { return maxDepth_; }
+    void setMaxDepth(size_t depth) { maxDepth_ = depth; }
+
+    // Budget applied to each parse, parseValue() and buildJson() call.
+    const ParseLimits &limits() const { return limits_; }
+    void setLimits(const ParseLimits &limits) { limits_ = limits; }
+
+    // RAW keeps numbers as their source text (JsonValue::number_raw_t):
+    // conversion is deferred to first numeric access and serialization
+    // re-emits the original digits. Fixed to RAW when Options::lazy_numbers
+    // is set.
+    enum NumberMode
+    {
+        BINARY,
+        RAW
+    };
+
+    NumberMode numberMode() const { return numberMode_; }
+    // Throws std::invalid_argument for BINARY when Options::lazy_numbers is
+    // set, since such a parser always keeps numbers raw.
+    void setNumberMode(NumberMode mode)
+    {
+        if constexpr (Options::lazy_numbers)
+        {
+            if (mode != RAW)
+                LIBJSON_THROW(std::invalid_argument("Number mode is fixed to RAW by Options::lazy_numbers"));
+        }
+        numberMode_ = mode;
+    }
+
+    // Store arrays made only of numbers as packed buffers (see
+    // JsonValue::pack()). Has no effect on raw numbers.
+    bool packArrays() const { return packArrays_; }
+    void setPackArrays(bool pack) { packArrays_ = pack; }
+
 private:
+    BasicLexer<Options> lexer_;
     std::vector<Token> tokens_;
     size_t pos_;
 
-    Token current();
+    const Token &current() const;
     void consume();
     void reset() { pos_ = 0; }
 
-    JsonValue parseValue(Token t);
-    JsonValue::string_t parseString(Token t);
-    JsonValue::number_float_t parseFloat(Token t);
-    JsonValue::number_integer_t parseInteger(Token t);
-    JsonValue::object_t parseObject(Token t);
-    JsonValue::array_t parseArray(Token t);
-    JsonValue::boolean_t parseBoolean(Token t);
-    JsonValue::nullptr_t parseNull(Token t);
+    struct Context
+    {
+        Token::Type type;
+        bool expectValue;
+        bool expectKey;
+        bool expectColon;
+        bool expectComma;
+        bool hasValue;
+    };
+
+    std::vector<Context> contexts_;
+
+    struct Frame
+    {
+        bool isObject = false;
+        bool expectKey = true;
+        std::string key;
+        size_t keyPos = 0;
+        JsonValue::object_t object;
+        JsonValue::array_t array;
+    };
+
+    std::vector<Frame> frames_;
+    size_t maxDepth_ = default_max_depth;
+    NumberMode numberMode_ = Options::lazy_numbers ? RAW : BINARY;
+    bool packArrays_ = Options::pack_arrays;
+    bool moveTokens_ = false;
+    bool consumed_ = false;
+    ParseError error_{ParseError::UNEXPECTED_END, 0};
+
+    ParseLimits limits_;
+    size_t elements_ = 0;
+    size_t allocated_ = 0;
+    bool hasDeadline_ = false;
+    std::chrono::steady_clock::time_point deadline_;
+
+    // Estimated hash node cost of an object member beyond its key and value.
+    static constexpr size_t member_overhead = sizeof(std::string) + sizeof(void *) + sizeof(size_t);
+    // Resets the budget for a new parse; false if inputSize is over the limit.
+    bool begin(size_t inputSize);
+    bool expired() const { return hasDeadline_ && std::chrono::steady_clock::now() > deadline_; }
+    bool tokenise()
+    {
+        auto deadline = hasDeadline_ ? deadline_ : std::chrono::steady_clock::time_point::max();
+        return lexer_.tokenise(tokens_, limits_, deadline, error_);
+    }
+    bool charge(size_t elements, size_t bytes, size_t offset)
+    {
+        elements_ += elements;
+        allocated_ += bytes;
+        if (elements_ > limits_.max_elements)
+            return fail(ParseError::TOO_MANY_ELEMENTS, offset);
+        if (allocated_ > limits_.max_allocated_bytes)
+            return fail(ParseError::MEMORY_LIMIT_EXCEEDED, offset);
+        if (elements_ % ParseLimits::deadline_interval == 0 && expired())
+            return fail(ParseError::DEADLINE_EXCEEDED, offset);
+        return true;
+    }
+
+    bool fail(ParseError::Code code, size_t offset)
+    {
+        error_ = {code, offset};
+        return false;
+    }
+    bool fail(const Token &t);
+
+    std::string lexeme(Token &t) { return moveTokens_ ? std::move(t.lexeme) : t.lexeme; }
+
+    std::expected<Json, ParseError> build(bool moveTokens);
+    bool buildValue(JsonValue &out);
+    JsonValue buildFragment(std::string_view text);
+
+    Token keyToken_{Token::EOFTOKEN};
+
+    std::optional<JsonValue> project(std::string_view in, size_t &i, const Projection &projection, uint32_t node);
+    std::string_view scanKey(std::string_view in, size_t &i);
+    static size_t skipWhitespace(std::string_view in, size_t i);
+    static size_t skipString(std::string_view in, size_t i);
+    static size_t skipValue(std::string_view in, size_t i);
+    static size_t findBracketOrQuote(const char *p, size_t i, size_t n);
+    JsonValue::string_t parseString(Token &t);
+    bool parseNumber(Token &t, JsonValue &value);
+    JsonValue::boolean_t parseBoolean(const Token &t);
+    JsonValue::nullptr_t parseNull(const Token &t);
 };
 
-inline Token Parser::current()
+template <typename Options>
+const Token &BasicParser<Options>::current() const
 {
+    static const Token eof(Token::EOFTOKEN);
     if (pos_ < tokens_.size())
         return tokens_[pos_];
 
-    return Token(Token::EOFTOKEN);
+    return eof;
 }
 
-inline void Parser::consume()
+template <typename Options>
+void BasicParser<Options>::consume()
 {
     if (pos_ < tokens_.size())
         pos_++;
 }
 
-bool Parser::validate()
+template <typename Options>
+bool BasicParser<Options>::validate()
 {
     reset();
     if (tokens_.empty())
-        return false;
+        return fail(ParseError::UNEXPECTED_END, 0);
 
-    struct Context
+    std::vector<Context> &s = contexts_;
+    s.clear();
+    pos_ = 0;
+
+    // Depth is checked here too so hostile nesting fails before the
+    // context stack grows.
+    auto push = [this, &s](const Token &t)
     {
-        Token::Type type;
-        bool expectValue;
-        bool expectColon;
-        bool expectComma;
-        bool hasValue;
+        if (s.size() >= maxDepth_)
+            return fail(ParseError::DEPTH_EXCEEDED, t.pos);
+        bool object = t.type == Token::LBRACE;
+        s.push_back({t.type, !object, object, false, false, false});
+        return true;
     };
 
-    std::stack<Context> s;
-    pos_ = 0;
-
     while (pos_ < tokens_.size())
     {
-        Token t = current();
+        const Token &t = current();
         consume();
 
         if (s.empty())
         {
+            // Past the first token, an empty stack means the root is closed.
+            if (pos_ > 1)
+            {
+                if (t.type == Token::EOFTOKEN && pos_ == tokens_.size())
+                    return true;
+                return fail(t);
+            }
             if (t.type != Token::LBRACE && t.type != Token::LBRACKET)
+                return fail(t);
+            if (!push(t))
                 return false;
-            s.push({t.type, true, false, false, false});
             continue;
         }
 
-        Context &ctx = s.top();
+        Context &ctx = s.back();
 
         switch (t.type)
         {
         case Token::LBRACE:
         case Token::LBRACKET:
             if (!ctx.expectValue)
-                return false;
-            s.push({t.type, true, false, false, false});
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
             ctx.expectValue = false;
             ctx.expectComma = true;
             ctx.hasValue = true;
+            if (!push(t))
+                return false;
             break;
 
         case Token::RBRACE:
             if (ctx.type != Token::LBRACE)
-                return false;
-            if (ctx.expectColon || (ctx.expectValue && ctx.hasValue))
-                return false;
-            s.pop();
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
+            if (ctx.expectColon || ctx.expectValue || (ctx.expectKey && ctx.hasValue))
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
+            s.pop_back();
             if (!s.empty())
             {
-                Context &parent = s.top();
+                Context &parent = s.back();
                 parent.expectValue = false;
                 parent.expectComma = true;
                 parent.hasValue = true;
@@ -113,13 +281,13 @@ bool Parser::validate()
 
         case Token::RBRACKET:
             if (ctx.type != Token::LBRACKET)
-                return false;
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
             if (ctx.expectValue && ctx.hasValue)
-                return false;
-            s.pop();
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
+            s.pop_back();
             if (!s.empty())
             {
-                Context &parent = s.top();
+                Context &parent = s.back();
                 parent.expectValue = false;
                 parent.expectComma = true;
                 parent.hasValue = true;
@@ -127,24 +295,20 @@ bool Parser::validate()
             break;
 
         case Token::STRING:
-            if (ctx.type == Token::LBRACE)
+            if (ctx.expectKey)
             {
-                if (!ctx.expectValue)
-                    return false;
+                ctx.expectKey = false;
                 ctx.expectColon = true;
-                ctx.expectValue = false;
                 ctx.hasValue = true;
             }
-            else if (ctx.type == Token::LBRACKET)
+            else
             {
                 if (!ctx.expectValue)
-                    return false;
+                    return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
                 ctx.expectValue = false;
                 ctx.expectComma = true;
                 ctx.hasValue = true;
             }
-            else
-                return false;
             break;
 
         case Token::INTEGER:
@@ -153,144 +317,573 @@ bool Parser::validate()
         case Token::FALSE:
         case Token::NULLTOKEN:
             if (!ctx.expectValue)
-                return false;
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
             ctx.expectValue = false;
             ctx.expectComma = true;
-            ctx.expectColon = false;
             ctx.hasValue = true;
             break;
 
         case Token::COLON:
             if (!ctx.expectColon)
-                return false;
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
             ctx.expectColon = false;
             ctx.expectValue = true;
-            ctx.expectComma = false;
             break;
 
         case Token::COMMA:
             if (!ctx.expectComma)
-                return false;
+                return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
             ctx.expectComma = false;
-            ctx.expectValue = true;
-            ctx.expectColon = (ctx.type == Token::LBRACE);
+            if (ctx.type == Token::LBRACE)
+                ctx.expectKey = true;
+            else
+                ctx.expectValue = true;
             break;
 
         default:
-            return false;
+            return fail(t);
         }
     }
 
-    return s.empty();
+    if (!s.empty())
+        return fail(ParseError::UNEXPECTED_END, tokens_.back().pos);
+    return true;
+}
+
+template <typename Options>
+bool BasicParser<Options>::fail(const Token &t)
+{
+    if (t.type == Token::INVALID)
+        return fail(ParseError::INVALID_TOKEN, t.pos);
+    if (t.type == Token::EOFTOKEN)
+        return fail(ParseError::UNEXPECTED_END, t.pos);
+    return fail(ParseError::UNEXPECTED_TOKEN, t.pos);
+}
+
+template <typename Options>
+Json BasicParser<Options>::parse(std::string_view input)
+{
+    auto result = tryParse(input);
+    if (!result)
+        LIBJSON_THROW(std::runtime_error(result.error().describe()));
+    return std::move(*result);
 }
 
-inline Json Parser::buildJson()
+// Reuses the lexer input buffer, token storage and validation/build stacks
+// from previous calls; only the returned document is freshly allocated.
+// Malformed input is reported through the return value, never by throwing.
+template <typename Options>
+std::expected<Json, ParseError> BasicParser<Options>::tryParse(std::string_view input)
 {
-    if (!validate())
-        throw std::runtime_error("Invalid JSON");
+    if (!begin(input.size()))
+        return std::unexpected(error_);
+    lexer_.reset(input);
+    consumed_ = false;
+    if (!tokenise())
+        return std::unexpected(error_);
+    return build(true);
+}
+
+template <typename Options>
+Json BasicParser<Options>::buildJson()
+{
+    if (consumed_)
+        LIBJSON_THROW(std::logic_error("Token buffer already consumed"));
+
+    begin(0);
+    auto result = build(false);
+    if (!result)
+        LIBJSON_THROW(std::runtime_error(result.error().describe()));
+    return std::move(*result);
+}
+
+template <typename Options>
+Json BasicParser<Options>::takeJson()
+{
+    if (consumed_)
+        LIBJSON_THROW(std::logic_error("Token buffer already consumed"));
+
+    begin(0);
+    auto result = build(true);
+    if (!result)
+        LIBJSON_THROW(std::runtime_error(result.error().describe()));
+    return std::move(*result);
+}
+
+template <typename Options>
+std::expected<Json, ParseError> BasicParser<Options>::build(bool moveTokens)
+{
+    // The lexer looks at the clock only every few thousand tokens; this
+    // catches a deadline it used up on the tail.
+    if (expired())
+    {
+        fail(ParseError::DEADLINE_EXCEEDED, 0);
+        return std::unexpected(error_);
+    }
+
+    if constexpr (!Options::trusted_input)
+    {
+        if (!validate())
+            return std::unexpected(error_);
+    }
 
     reset();
-    JsonValue v = parseValue(current());
+    if (current().type != Token::LBRACE)
+    {
+        fail(ParseError::ROOT_NOT_OBJECT, current().pos);
+        return std::unexpected(error_);
+    }
 
-    if (!v.is_object())
-        throw std::runtime_error("Root element is not an object");
+    moveTokens_ = moveTokens;
+    consumed_ = moveTokens;
+    JsonValue root;
+    if (!buildValue(root))
+        return std::unexpected(error_);
+    return std::move(root).get<JsonValue::object_t>();
+}
 
-    return static_cast<JsonValue::object_t>(v);
+template <typename Options>
+bool BasicParser<Options>::buildValue(JsonValue &out)
+{
+    frames_.clear();
+
+    for (;;)
+    {
+        if (pos_ >= tokens_.size())
+            return fail(ParseError::UNEXPECTED_END, tokens_.empty() ? 0 : tokens_.back().pos);
+        Token &t = tokens_[pos_];
+        consume();
+
+        JsonValue value;
+        switch (t.type)
+        {
+        case Token::LBRACE:
+        case Token::LBRACKET:
+            if (frames_.size() >= maxDepth_)
+                return fail(ParseError::DEPTH_EXCEEDED, t.pos);
+            if (!charge(1, sizeof(JsonValue), t.pos))
+                return false;
+            frames_.emplace_back();
+            frames_.back().isObject = t.type == Token::LBRACE;
+            continue;
+        case Token::RBRACE:
+        case Token::RBRACKET:
+        {
+            if (frames_.empty())
+                return fail(t);
+            Frame &frame = frames_.back();
+            if (frame.isObject)
+            {
+                value = std::move(frame.object);
+            }
+            else
+            {
+                value = std::move(frame.array);
+                if (packArrays_)
+                    value.pack();
+            }
+            frames_.pop_back();
+            break;
+        }
+        case Token::COMMA:
+            continue;
+        case Token::STRING:
+            if (t.lexeme.size() > limits_.max_string_length)
+                return fail(ParseError::STRING_TOO_LONG, t.pos);
+            if (!frames_.empty() && frames_.back().isObject && frames_.back().expectKey)
+            {
+                if (!charge(0, member_overhead + t.lexeme.size(), t.pos))
+                    return false;
+                frames_.back().key = lexeme(t);
+                frames_.back().keyPos = t.pos;
+                frames_.back().expectKey = false;
+                if constexpr (!Options::trusted_input)
+                {
+                    if (current().type != Token::COLON)
+                        return fail(current());
+                }
+                consume();
+                continue;
+            }
+            if (!charge(1, sizeof(JsonValue) + t.lexeme.size(), t.pos))
+                return false;
+            value = parseString(t);
+            break;
+        case Token::INTEGER:
+        case Token::FLOAT:
+            if (!charge(1, sizeof(JsonValue), t.pos) || !parseNumber(t, value))
+                return false;
+            break;
+        case Token::TRUE:
+        case Token::FALSE:
+            if (!charge(1, sizeof(JsonValue), t.pos))
+                return false;
+            value = parseBoolean(t);
+            break;
+        case Token::NULLTOKEN:
+            if (!charge(1, sizeof(JsonValue), t.pos))
+                return false;
+            value = parseNull(t);
+            break;
+        default:
+            return fail(t);
+        }
+
+        if (frames_.empty())
+        {
+            out = std::move(value);
+            return true;
+        }
+
+        Frame &parent = frames_.back();
+        if (parent.isObject)
+        {
+            if constexpr (Options::allow_duplicate_keys)
+                parent.object[std::move(parent.key)] = std::move(value);
+            else if (!parent.object.try_emplace(std::move(parent.key), std::move(value)).second)
+                return fail(ParseError::DUPLICATE_KEY, parent.keyPos);
+            parent.expectKey = true;
+        }
+        else
+        {
+            parent.array.push_back(std::move(value));
+        }
+    }
 }
 
-inline JsonValue Parser::parseValue(Token t)
+// Materialises only the subtrees selected by the projection. Everything else
+// is skipped at scan speed without allocating; skipped regions are only
+// checked for balanced nesting and terminated strings.
+template <typename Options>
+Json BasicParser<Options>::parse(std::string_view input, const Projection &projection)
 {
-    consume();
-    switch (t.type)
+    if (projection.terminal(Projection::root))
+        return parse(input);
+
+    if (!begin(input.size()))
+        LIBJSON_THROW(std::runtime_error(error_.describe()));
+    size_t i = skipWhitespace(input, 0);
+    if (i >= input.size() || input[i] != '{')
+        LIBJSON_THROW(std::runtime_error("Root element is not an object"));
+
+    std::optional<JsonValue> v = project(input, i, projection, Projection::root);
+    if (skipWhitespace(input, i) != input.size())
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+
+    return std::move(*v).get<JsonValue::object_t>();
+}
+
+template <typename Options>
+std::optional<JsonValue> BasicParser<Options>::project(std::string_view in, size_t &i, const Projection &projection, uint32_t node)
+{
+    const size_t n = in.size();
+    auto expect = [&](char c)
     {
-    case Token::STRING:
-        return parseString(t);
-    case Token::INTEGER:
-        return parseInteger(t);
-    case Token::FLOAT:
-        return parseFloat(t);
-    case Token::TRUE:
-        return parseBoolean(t);
-    case Token::FALSE:
-        return parseBoolean(t);
-    case Token::LBRACE:
-        return parseObject(t);
-    case Token::LBRACKET:
-        return parseArray(t);
-    case Token::NULLTOKEN:
-        return parseNull(t);
-    default:
-        throw std::runtime_error("Invalid token");
+        i = skipWhitespace(in, i);
+        if (i >= n || in[i] != c)
+            LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+        ++i;
+    };
+    auto next = [&](char close)
+    {
+        i = skipWhitespace(in, i);
+        if (i < n && in[i] == ',')
+        {
+            ++i;
+            return true;
+        }
+        expect(close);
+        return false;
+    };
+    auto select = [&](uint32_t child) -> std::optional<JsonValue>
+    {
+        i = skipWhitespace(in, i);
+        if (child == Projection::npos)
+        {
+            i = skipValue(in, i);
+            return std::nullopt;
+        }
+        if (projection.terminal(child))
+        {
+            size_t start = i;
+            i = skipValue(in, i);
+            return buildFragment(in.substr(start, i - start));
+        }
+        return project(in, i, projection, child);
+    };
+
+    i = skipWhitespace(in, i);
+    if (i >= n)
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+
+    if (in[i] == '{')
+    {
+        JsonValue::object_t result;
+        ++i;
+        i = skipWhitespace(in, i);
+        if (i < n && in[i] == '}')
+        {
+            ++i;
+            return JsonValue(std::move(result));
+        }
+        do
+        {
+            i = skipWhitespace(in, i);
+            std::string_view key = scanKey(in, i);
+            expect(':');
+            uint32_t child = projection.key(node, key);
+            if (child == Projection::npos)
+            {
+                i = skipValue(in, skipWhitespace(in, i));
+                continue;
+            }
+            std::string k(key);
+            if (auto v = select(child))
+                result[std::move(k)] = std::move(*v);
+        } while (next('}'));
+        return JsonValue(std::move(result));
+    }
+
+    if (in[i] == '[')
+    {
+        JsonValue::array_t result;
+        ++i;
+        i = skipWhitespace(in, i);
+        if (i < n && in[i] == ']')
+        {
+            ++i;
+            return JsonValue(std::move(result));
+        }
+        size_t index = 0;
+        do
+        {
+            if (auto v = select(projection.index(node, index++)))
+                result.push_back(std::move(*v));
+        } while (next(']'));
+        JsonValue value(std::move(result));
+        if (packArrays_)
+            value.pack();
+        return value;
     }
+
+    i = skipValue(in, i);
+    return std::nullopt;
 }
 
-inline JsonValue::string_t Parser::parseString(Token t)
+// Returns the key at in[i] and advances past its closing quote. Keys without
+// escapes are returned as a view into the input; escaped keys are decoded
+// into a reused token.
+template <typename Options>
+std::string_view BasicParser<Options>::scanKey(std::string_view in, size_t &i)
 {
-    return t.lexeme;
+    if (i >= in.size() || in[i] != '"')
+        LIBJSON_THROW(std::runtime_error("Expected string as key in object"));
+
+    size_t start = i;
+    i = skipString(in, i);
+    std::string_view raw = in.substr(start + 1, i - start - 2);
+    if (raw.find('\\') == std::string_view::npos)
+        return raw;
+
+    lexer_.reset(in.substr(start, i - start));
+    lexer_.nextToken(keyToken_);
+    if (keyToken_.type != Token::STRING)
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+    return keyToken_.lexeme;
 }
 
-inline JsonValue::number_integer_t Parser::parseInteger(Token t)
+template <typename Options>
+JsonValue BasicParser<Options>::parseValue(std::string_view input)
 {
-    return std::stoi(t.lexeme);
+    if (!begin(input.size()))
+        LIBJSON_THROW(std::runtime_error(error_.describe()));
+    return buildFragment(input);
 }
 
-inline JsonValue::number_float_t Parser::parseFloat(Token t)
+template <typename Options>
+bool BasicParser<Options>::begin(size_t inputSize)
 {
-    return std::stod(t.lexeme);
+    elements_ = 0;
+    allocated_ = 0;
+    hasDeadline_ = limits_.timeout > std::chrono::nanoseconds::zero();
+    if (hasDeadline_)
+        deadline_ = std::chrono::steady_clock::now() + limits_.timeout;
+    if (inputSize > limits_.max_input_bytes)
+        return fail(ParseError::INPUT_TOO_LARGE, limits_.max_input_bytes);
+    return true;
 }
 
-inline JsonValue::boolean_t Parser::parseBoolean(Token t)
+template <typename Options>
+JsonValue BasicParser<Options>::buildFragment(std::string_view text)
 {
-    return t.type == Token::TRUE;
+    lexer_.reset(text);
+    consumed_ = false;
+    if (!tokenise())
+        LIBJSON_THROW(std::runtime_error(error_.describe()));
+    reset();
+
+    Token::Type type = tokens_.front().type;
+    if ((type == Token::LBRACE || type == Token::LBRACKET) && !validate())
+        LIBJSON_THROW(std::runtime_error(error_.describe()));
+
+    reset();
+    moveTokens_ = true;
+    consumed_ = true;
+    JsonValue v;
+    if (!buildValue(v))
+        LIBJSON_THROW(std::runtime_error(error_.describe()));
+    if (current().type != Token::EOFTOKEN)
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+    return v;
 }
 
-inline JsonValue::nullptr_t Parser::parseNull(Token t)
+template <typename Options>
+size_t BasicParser<Options>::skipWhitespace(std::string_view in, size_t i)
 {
-    return nullptr;
+    return CharClass::skipWhitespace(in.data(), i, in.size());
 }
 
-inline JsonValue::object_t Parser::parseObject(Token t)
+template <typename Options>
+size_t BasicParser<Options>::skipString(std::string_view in, size_t i)
 {
-    JsonValue::object_t j;
-    while (current().type != Token::RBRACE)
+    const char *p = in.data();
+    const size_t n = in.size();
+    ++i;
+    for (;;)
     {
-        Token key = current();
-        if (key.type != Token::STRING)
-            throw std::runtime_error("Expected string as key in object");
+        bool ascii = true;
+        i = Utf8::findSpecial(p, i, n, ascii);
+        if (i >= n)
+            LIBJSON_THROW(std::runtime_error("Unterminated string"));
+        if (p[i] == '"')
+            return i + 1;
+        if (p[i] != '\\')
+            LIBJSON_THROW(std::runtime_error("Control character in string"));
+        i += 2;
+    }
+}
 
-        consume();
+template <typename Options>
+size_t BasicParser<Options>::findBracketOrQuote(const char *p, size_t i, size_t n)
+{
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')), _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')), _mm_cmpeq_epi8(v, _mm_set1_epi8(']'))));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask)
+            return i + std::countr_zero(mask);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        char c = p[i];
+        if (c == '"' || c == '{' || c == '}' || c == '[' || c == ']')
+            return i;
+    }
+    return n;
+}
 
-        if (current().type != Token::COLON)
-            throw std::runtime_error("Expected ':' after key");
-        consume();
+template <typename Options>
+size_t BasicParser<Options>::skipValue(std::string_view in, size_t i)
+{
+    const char *p = in.data();
+    const size_t n = in.size();
+    if (i >= n)
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
 
-        j[key.lexeme] = parseValue(current());
+    if (p[i] == '"')
+        return skipString(in, i);
 
-        if (current().type == Token::COMMA)
-            consume();
-        else if (current().type != Token::RBRACE)
-            throw std::runtime_error("Expected ',' or '}' in object");
+    if (p[i] == '{' || p[i] == '[')
+    {
+        size_t depth = 0;
+        while ((i = findBracketOrQuote(p, i, n)) < n)
+        {
+            char c = p[i];
+            if (c == '"')
+            {
+                i = skipString(in, i);
+                continue;
+            }
+            if (c == '{' || c == '[')
+                ++depth;
+            else if (--depth == 0)
+                return i + 1;
+            ++i;
+        }
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
     }
-    consume();
-    return j;
+
+    size_t start = i;
+    while (i < n && p[i] != ',' && p[i] != '}' && p[i] != ']' &&
+           p[i] != ' ' && p[i] != '\t' && p[i] != '\n' && p[i] != '\r')
+        ++i;
+    if (i == start)
+        LIBJSON_THROW(std::runtime_error("Invalid JSON"));
+    return i;
 }
 
-inline JsonValue::array_t Parser::parseArray(Token t)
+template <typename Options>
+JsonValue::string_t BasicParser<Options>::parseString(Token &t)
 {
-    JsonValue::array_t arr;
+    return lexeme(t);
+}
 
-    while (current().type != Token::RBRACKET)
+template <typename Options>
+bool BasicParser<Options>::parseNumber(Token &t, JsonValue &value)
+{
+    if constexpr (Options::lazy_numbers)
     {
-        arr.push_back(parseValue(current()));
+        value = JsonValue::number_raw_t(lexeme(t), JsonValue::number_raw_t::unchecked);
+        return true;
+    }
+    else
+    {
+        if (numberMode_ == RAW)
+        {
+            value = JsonValue::number_raw_t(lexeme(t), JsonValue::number_raw_t::unchecked);
+            return true;
+        }
+    }
 
-        if (current().type == Token::COMMA)
-            consume();
-        else if (current().type != Token::RBRACKET)
-            throw std::runtime_error("Expected ',' or ']' in array");
+    const char *first = t.lexeme.data();
+    const char *last = first + t.lexeme.size();
+    if (!Options::integers_as_double && t.type == Token::INTEGER)
+    {
+        JsonValue::number_integer_t n;
+        if (std::from_chars(first, last, n).ec != std::errc())
+            return fail(ParseError::NUMBER_OUT_OF_RANGE, t.pos);
+        value = n;
     }
+    else
+    {
+        JsonValue::number_float_t d;
+        if (std::from_chars(first, last, d).ec != std::errc())
+            return fail(ParseError::NUMBER_OUT_OF_RANGE, t.pos);
+        value = d;
+    }
+    return true;
+}
 
-    consume();
-    return arr;
+template <typename Options>
+JsonValue::boolean_t BasicParser<Options>::parseBoolean(const Token &t)
+{
+    return t.type == Token::TRUE;
+}
+
+template <typename Options>
+JsonValue::nullptr_t BasicParser<Options>::parseNull(const Token &t)
+{
+    return nullptr;
 }
 
+using Parser = BasicParser<DefaultParseOptions>;
+using StrictParser = BasicParser<StrictParseOptions>;
+using TrustedParser = BasicParser<TrustedParseOptions>;
+
 #endif // PARSER_H
\ No newline at end of file
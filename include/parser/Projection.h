@@ -0,0 +1,171 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include "json/Config.h"
+
+#include <charconv>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// A set of JSON Pointer paths compiled into a trie. A "*" segment matches
+// every key of an object or every element of an array; "" selects the whole
+// document. Used by Parser::parse(input, projection).
+class Projection
+{
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    static constexpr uint32_t root = 0;
+
+    Projection(std::initializer_list<std::string_view> paths) : nodes_(1)
+    {
+        for (std::string_view path : paths)
+            add(path);
+        merge(root);
+    }
+
+    explicit Projection(const std::vector<std::string> &paths) : nodes_(1)
+    {
+        for (const auto &path : paths)
+            add(path);
+        merge(root);
+    }
+
+    bool terminal(uint32_t node) const { return nodes_[node].terminal; }
+
+    uint32_t key(uint32_t node, std::string_view key) const;
+    uint32_t index(uint32_t node, size_t index) const;
+
+private:
+    struct Node
+    {
+        std::vector<std::pair<std::string, uint32_t>> children;
+        uint32_t wildcard = npos;
+        bool terminal = false;
+    };
+
+    std::vector<Node> nodes_;
+
+    void add(std::string_view path);
+    uint32_t child(uint32_t node, std::string segment);
+    void unite(uint32_t into, uint32_t from);
+    void merge(uint32_t node);
+    static std::string unescape(std::string_view segment);
+};
+
+inline void Projection::add(std::string_view path)
+{
+    if (!path.empty() && path.front() != '/')
+        LIBJSON_THROW(std::invalid_argument("Projection path must start with '/'"));
+
+    uint32_t node = root;
+    while (!path.empty())
+    {
+        path.remove_prefix(1);
+        size_t end = path.find('/');
+        std::string segment = unescape(path.substr(0, end));
+        path = end == std::string_view::npos ? std::string_view() : path.substr(end);
+
+        node = child(node, std::move(segment));
+    }
+    nodes_[node].terminal = true;
+}
+
+inline uint32_t Projection::child(uint32_t node, std::string segment)
+{
+    if (segment == "*")
+    {
+        if (nodes_[node].wildcard != npos)
+            return nodes_[node].wildcard;
+    }
+    else
+    {
+        for (const auto &[k, next] : nodes_[node].children)
+            if (k == segment)
+                return next;
+    }
+
+    uint32_t next = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    if (segment == "*")
+        nodes_[node].wildcard = next;
+    else
+        nodes_[node].children.emplace_back(std::move(segment), next);
+    return next;
+}
+
+// Copies the paths below `from` into `into`. The trie is a tree, so `from`
+// never lies inside `into` and the copy terminates.
+inline void Projection::unite(uint32_t into, uint32_t from)
+{
+    if (nodes_[from].terminal)
+        nodes_[into].terminal = true;
+    for (size_t i = 0; i < nodes_[from].children.size(); ++i)
+    {
+        std::string segment = nodes_[from].children[i].first;
+        uint32_t next = nodes_[from].children[i].second;
+        unite(child(into, std::move(segment)), next);
+    }
+    if (nodes_[from].wildcard != npos)
+        unite(child(into, "*"), nodes_[from].wildcard);
+}
+
+// key() and index() follow a literal child in preference to the wildcard,
+// so every literal child must also carry whatever the wildcard selects.
+inline void Projection::merge(uint32_t node)
+{
+    uint32_t wildcard = nodes_[node].wildcard;
+    for (size_t i = 0; i < nodes_[node].children.size(); ++i)
+    {
+        uint32_t next = nodes_[node].children[i].second;
+        if (wildcard != npos)
+            unite(next, wildcard);
+        merge(next);
+    }
+    if (wildcard != npos)
+        merge(wildcard);
+}
+
+inline std::string Projection::unescape(std::string_view segment)
+{
+    std::string out;
+    out.reserve(segment.size());
+    for (size_t i = 0; i < segment.size(); ++i)
+    {
+        if (segment[i] == '~' && i + 1 < segment.size() && (segment[i + 1] == '0' || segment[i + 1] == '1'))
+            out += segment[++i] == '0' ? '~' : '/';
+        else
+            out += segment[i];
+    }
+    return out;
+}
+
+inline uint32_t Projection::key(uint32_t node, std::string_view key) const
+{
+    const Node &n = nodes_[node];
+    for (const auto &[k, child] : n.children)
+        if (k == key)
+            return child;
+    return n.wildcard;
+}
+
+inline uint32_t Projection::index(uint32_t node, size_t index) const
+{
+    const Node &n = nodes_[node];
+    if (!n.children.empty())
+    {
+        char buf[24];
+        char *end = std::to_chars(buf, buf + sizeof(buf), index).ptr;
+        std::string_view digits(buf, static_cast<size_t>(end - buf));
+        for (const auto &[k, child] : n.children)
+            if (k == digits)
+                return child;
+    }
+    return n.wildcard;
+}
+
+#endif // PROJECTION_H
@@ -0,0 +1,476 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "json/Config.h"
+#include "json/Json.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LIBJSON_SNAPSHOT_MMAP 1
+#endif
+
+// Snapshot layout (native endianness, every node 8-byte aligned):
+//
+//   header : "LJSN" | u32 version | u64 root offset | u64 total size | u64 reserved
+//   node   : u32 type | u32 reserved | u64 payload | body
+//
+// The payload holds the scalar for null/boolean/integer/float nodes, the byte
+// length for strings and raw numbers (body: bytes + NUL; a raw number keeps
+// the source digits of a value that fits neither an i64 nor a finite double)
+// and the element count for arrays
+// (body: i64 child offsets) and objects (body: i64 key/value offset pairs,
+// sorted by key bytes). Child offsets are relative to the referring node, so a
+// snapshot can be mapped at any address and read in place.
+class Snapshot
+{
+public:
+    enum Type : uint32_t
+    {
+        NULLVALUE,
+        BOOLEAN,
+        INTEGER,
+        FLOAT,
+        STRING,
+        ARRAY,
+        OBJECT,
+        NUMBER
+    };
+
+    static constexpr char magic[4] = {'L', 'J', 'S', 'N'};
+    static constexpr uint32_t version = 1;
+    static constexpr size_t header_size = 32;
+    static constexpr size_t node_size = 16;
+
+    template <typename T>
+    static T load(const char *p)
+    {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+};
+
+class SnapshotWriter
+{
+public:
+    std::string write(const Json &json);
+    void writeFile(const Json &json, const std::string &path);
+
+private:
+    std::string buf_;
+
+    template <typename T>
+    void put(T v) { buf_.append(reinterpret_cast<const char *>(&v), sizeof(T)); }
+    void align() { buf_.append((8 - buf_.size() % 8) % 8, '\0'); }
+
+    uint64_t node(Snapshot::Type type, uint64_t payload);
+    uint64_t writeValue(const JsonValue &v);
+    uint64_t writeString(std::string_view s, Snapshot::Type type = Snapshot::STRING);
+    uint64_t writeArray(const JsonValue::array_t &arr);
+    template <typename T>
+    uint64_t writePacked(std::span<const T> values);
+    uint64_t writeObject(const Json &obj);
+};
+
+inline std::string SnapshotWriter::write(const Json &json)
+{
+    buf_.clear();
+    buf_.append(Snapshot::header_size, '\0');
+
+    uint64_t root = writeObject(json);
+    uint64_t size = buf_.size();
+
+    std::memcpy(buf_.data(), Snapshot::magic, sizeof(Snapshot::magic));
+    std::memcpy(buf_.data() + 4, &Snapshot::version, sizeof(uint32_t));
+    std::memcpy(buf_.data() + 8, &root, sizeof(uint64_t));
+    std::memcpy(buf_.data() + 16, &size, sizeof(uint64_t));
+
+    return std::move(buf_);
+}
+
+inline void SnapshotWriter::writeFile(const Json &json, const std::string &path)
+{
+    std::string bytes = write(json);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+        LIBJSON_THROW(std::runtime_error("Failed to write snapshot: " + path));
+}
+
+inline uint64_t SnapshotWriter::node(Snapshot::Type type, uint64_t payload)
+{
+    align();
+    uint64_t offset = buf_.size();
+    put<uint32_t>(type);
+    put<uint32_t>(0);
+    put<uint64_t>(payload);
+    return offset;
+}
+
+inline uint64_t SnapshotWriter::writeValue(const JsonValue &v)
+{
+    if (v.is_null())
+        return node(Snapshot::NULLVALUE, 0);
+    if (v.is_boolean())
+        return node(Snapshot::BOOLEAN, v.get<JsonValue::boolean_t>() ? 1 : 0);
+    if (v.is_integer())
+        return node(Snapshot::INTEGER, static_cast<uint64_t>(v.get<JsonValue::number_integer_t>()));
+    if (v.is_float())
+    {
+        uint64_t bits;
+        double d = v.get<JsonValue::number_float_t>();
+        std::memcpy(&bits, &d, sizeof(bits));
+        return node(Snapshot::FLOAT, bits);
+    }
+    if (v.is_raw_number())
+    {
+        const auto &n = v.get<JsonValue::number_raw_t>();
+        JsonValue::number_integer_t i;
+        if (n.try_get(i))
+            return node(Snapshot::INTEGER, static_cast<uint64_t>(i));
+        // Integers past i64 would lose digits as a double.
+        double d;
+        if (n.is_integer() || !n.try_get(d))
+            return writeString(n.raw(), Snapshot::NUMBER);
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return node(Snapshot::FLOAT, bits);
+    }
+    if (v.is_string())
+        return writeString(v.get<JsonValue::string_t>());
+    if (v.is_packed<JsonValue::number_integer_t>())
+        return writePacked(v.packed<JsonValue::number_integer_t>());
+    if (v.is_packed<JsonValue::number_float_t>())
+        return writePacked(v.packed<JsonValue::number_float_t>());
+    if (v.is_array())
+        return writeArray(v.get<JsonValue::array_t>());
+    return writeObject(v.get<JsonValue::object_t>());
+}
+
+inline uint64_t SnapshotWriter::writeString(std::string_view s, Snapshot::Type type)
+{
+    uint64_t offset = node(type, s.size());
+    buf_.append(s);
+    buf_.push_back('\0');
+    return offset;
+}
+
+inline uint64_t SnapshotWriter::writeArray(const JsonValue::array_t &arr)
+{
+    std::vector<uint64_t> children;
+    children.reserve(arr.size());
+    for (const auto &v : arr)
+        children.push_back(writeValue(v));
+
+    uint64_t offset = node(Snapshot::ARRAY, arr.size());
+    for (uint64_t child : children)
+        put<int64_t>(static_cast<int64_t>(child - offset));
+    return offset;
+}
+
+template <typename T>
+uint64_t SnapshotWriter::writePacked(std::span<const T> values)
+{
+    std::vector<uint64_t> children;
+    children.reserve(values.size());
+    for (T v : values)
+    {
+        uint64_t bits;
+        if constexpr (std::is_same_v<T, JsonValue::number_integer_t>)
+            bits = static_cast<uint64_t>(v);
+        else
+            std::memcpy(&bits, &v, sizeof(bits));
+        children.push_back(node(std::is_same_v<T, JsonValue::number_integer_t> ? Snapshot::INTEGER : Snapshot::FLOAT, bits));
+    }
+
+    uint64_t offset = node(Snapshot::ARRAY, values.size());
+    for (uint64_t child : children)
+        put<int64_t>(static_cast<int64_t>(child - offset));
+    return offset;
+}
+
+inline uint64_t SnapshotWriter::writeObject(const Json &obj)
+{
+    std::vector<std::pair<std::string_view, const JsonValue *>> entries;
+    for (const auto &kv : obj)
+        entries.emplace_back(kv.first, &kv.second);
+    std::sort(entries.begin(), entries.end(),
+              [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+
+    std::vector<std::pair<uint64_t, uint64_t>> children;
+    children.reserve(entries.size());
+    for (const auto &[key, value] : entries)
+    {
+        uint64_t k = writeString(key);
+        children.emplace_back(k, writeValue(*value));
+    }
+
+    uint64_t offset = node(Snapshot::OBJECT, entries.size());
+    for (const auto &[k, v] : children)
+    {
+        put<int64_t>(static_cast<int64_t>(k - offset));
+        put<int64_t>(static_cast<int64_t>(v - offset));
+    }
+    return offset;
+}
+
+// A node inside a snapshot. Every access is checked against the snapshot
+// bounds, so a truncated or corrupt file throws std::runtime_error rather
+// than reading past the mapping; wrong-type access throws std::runtime_error
+// and an index past the end std::out_of_range.
+class SnapshotValue
+{
+public:
+    SnapshotValue(std::string_view bytes, uint64_t offset);
+
+    Snapshot::Type type() const { return static_cast<Snapshot::Type>(Snapshot::load<uint32_t>(node())); }
+
+    bool is_null() const { return type() == Snapshot::NULLVALUE; }
+    bool is_boolean() const { return type() == Snapshot::BOOLEAN; }
+    bool is_integer() const { return type() == Snapshot::INTEGER; }
+    bool is_float() const { return type() == Snapshot::FLOAT; }
+    bool is_string() const { return type() == Snapshot::STRING; }
+    bool is_array() const { return type() == Snapshot::ARRAY; }
+    bool is_object() const { return type() == Snapshot::OBJECT; }
+    bool is_raw_number() const { return type() == Snapshot::NUMBER; }
+
+    bool as_boolean() const
+    {
+        expect(Snapshot::BOOLEAN);
+        return payload() != 0;
+    }
+    int64_t as_integer() const
+    {
+        expect(Snapshot::INTEGER);
+        return static_cast<int64_t>(payload());
+    }
+    double as_float() const;
+    std::string_view as_string() const { return text(Snapshot::STRING); }
+    // Source digits of a NUMBER node.
+    std::string_view as_raw_number() const { return text(Snapshot::NUMBER); }
+
+    // Element count of an array or object.
+    size_t size() const;
+
+    SnapshotValue operator[](size_t i) const;
+
+    std::string_view key(size_t i) const { return member(i, 0).as_string(); }
+    SnapshotValue value(size_t i) const { return member(i, 1); }
+
+    std::optional<SnapshotValue> find(std::string_view key) const;
+    bool contains(std::string_view key) const { return find(key).has_value(); }
+    SnapshotValue operator[](std::string_view key) const;
+
+private:
+    std::string_view bytes_;
+    uint64_t offset_;
+
+    const char *node() const { return bytes_.data() + offset_; }
+    uint64_t payload() const { return Snapshot::load<uint64_t>(node() + 8); }
+    void expect(Snapshot::Type type) const;
+    std::string_view text(Snapshot::Type type) const;
+    SnapshotValue child(size_t slot) const;
+    SnapshotValue member(size_t i, size_t half) const;
+};
+
+inline SnapshotValue::SnapshotValue(std::string_view bytes, uint64_t offset) : bytes_(bytes), offset_(offset)
+{
+    if (offset_ % 8 != 0 || offset_ > bytes_.size() || bytes_.size() - offset_ < Snapshot::node_size ||
+        Snapshot::load<uint32_t>(node()) > Snapshot::NUMBER)
+        LIBJSON_THROW(std::runtime_error("Truncated or corrupt snapshot"));
+}
+
+inline void SnapshotValue::expect(Snapshot::Type type) const
+{
+    static constexpr const char *names[] = {"null", "boolean", "integer", "float", "string", "array", "object", "raw number"};
+    if (this->type() != type)
+        LIBJSON_THROW(std::runtime_error(std::string("Snapshot value is not ") + names[type]));
+}
+
+inline double SnapshotValue::as_float() const
+{
+    expect(Snapshot::FLOAT);
+    uint64_t bits = payload();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+inline std::string_view SnapshotValue::text(Snapshot::Type type) const
+{
+    expect(type);
+    // The body holds the bytes and a NUL.
+    if (payload() >= bytes_.size() - offset_ - Snapshot::node_size)
+        LIBJSON_THROW(std::runtime_error("Truncated or corrupt snapshot"));
+    return {node() + Snapshot::node_size, payload()};
+}
+
+inline size_t SnapshotValue::size() const
+{
+    if (!is_array() && !is_object())
+        LIBJSON_THROW(std::runtime_error("Snapshot value is not an array or object"));
+    return payload();
+}
+
+inline SnapshotValue SnapshotValue::child(size_t slot) const
+{
+    if (slot >= (bytes_.size() - offset_ - Snapshot::node_size) / 8)
+        LIBJSON_THROW(std::runtime_error("Truncated or corrupt snapshot"));
+    int64_t rel = Snapshot::load<int64_t>(node() + Snapshot::node_size + slot * 8);
+    // A negative offset past the start wraps around and fails the bounds check.
+    return SnapshotValue(bytes_, offset_ + static_cast<uint64_t>(rel));
+}
+
+inline SnapshotValue SnapshotValue::operator[](size_t i) const
+{
+    expect(Snapshot::ARRAY);
+    if (i >= payload())
+        LIBJSON_THROW(std::out_of_range("Snapshot array index out of range"));
+    return child(i);
+}
+
+inline SnapshotValue SnapshotValue::member(size_t i, size_t half) const
+{
+    expect(Snapshot::OBJECT);
+    if (i >= payload())
+        LIBJSON_THROW(std::out_of_range("Snapshot object index out of range"));
+    return child(2 * i + half);
+}
+
+inline std::optional<SnapshotValue> SnapshotValue::find(std::string_view key) const
+{
+    expect(Snapshot::OBJECT);
+    size_t lo = 0;
+    size_t hi = payload();
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = this->key(mid).compare(key);
+        if (cmp == 0)
+            return value(mid);
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return std::nullopt;
+}
+
+inline SnapshotValue SnapshotValue::operator[](std::string_view key) const
+{
+    auto v = find(key);
+    if (!v)
+        LIBJSON_THROW(std::out_of_range("Key not found in snapshot object"));
+    return *v;
+}
+
+class SnapshotView
+{
+public:
+    explicit SnapshotView(std::string_view bytes);
+
+    SnapshotValue root() const { return SnapshotValue(bytes_, root_); }
+    std::string_view bytes() const { return bytes_; }
+
+private:
+    std::string_view bytes_;
+    uint64_t root_;
+};
+
+inline SnapshotView::SnapshotView(std::string_view bytes) : bytes_(bytes), root_(0)
+{
+    if (bytes_.size() < Snapshot::header_size ||
+        std::memcmp(bytes_.data(), Snapshot::magic, sizeof(Snapshot::magic)) != 0)
+        LIBJSON_THROW(std::runtime_error("Invalid snapshot header"));
+    if (Snapshot::load<uint32_t>(bytes_.data() + 4) != Snapshot::version)
+        LIBJSON_THROW(std::runtime_error("Unsupported snapshot version"));
+
+    root_ = Snapshot::load<uint64_t>(bytes_.data() + 8);
+    uint64_t size = Snapshot::load<uint64_t>(bytes_.data() + 16);
+    if (size != bytes_.size() || root_ % 8 != 0 || root_ + Snapshot::node_size > size)
+        LIBJSON_THROW(std::runtime_error("Truncated or corrupt snapshot"));
+}
+
+class SnapshotFile
+{
+public:
+    explicit SnapshotFile(const std::string &path);
+    ~SnapshotFile();
+
+    SnapshotFile(const SnapshotFile &) = delete;
+    SnapshotFile &operator=(const SnapshotFile &) = delete;
+
+    SnapshotView view() const { return SnapshotView(std::string_view(data_, size_)); }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+#ifndef LIBJSON_SNAPSHOT_MMAP
+    std::string buffer_;
+#endif
+};
+
+#ifdef LIBJSON_SNAPSHOT_MMAP
+
+inline SnapshotFile::SnapshotFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        LIBJSON_THROW(std::runtime_error("Failed to open snapshot: " + path));
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        LIBJSON_THROW(std::runtime_error("Failed to stat snapshot: " + path));
+    }
+
+    void *p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        LIBJSON_THROW(std::runtime_error("Failed to map snapshot: " + path));
+
+    data_ = static_cast<const char *>(p);
+    size_ = static_cast<size_t>(st.st_size);
+}
+
+inline SnapshotFile::~SnapshotFile()
+{
+    if (data_)
+        ::munmap(const_cast<char *>(data_), size_);
+}
+
+#else
+
+inline SnapshotFile::SnapshotFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        LIBJSON_THROW(std::runtime_error("Failed to open snapshot: " + path));
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+inline SnapshotFile::~SnapshotFile() = default;
+
+#endif
+
+#endif // SNAPSHOT_H
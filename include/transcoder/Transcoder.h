@@ -0,0 +1,301 @@
+#ifndef TRANSCODER_H
+#define TRANSCODER_H
+
+#include "io/Sink.h"
+#include "lexer/Utf8.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Byte-to-byte JSON reformatter. Strips whitespace (MINIFY) or re-indents
+// (PRETTY) without building a DOM: string contents are copied verbatim, key
+// order is preserved and memory use is bounded by the output buffer. Input
+// can be fed in arbitrary chunks; the input is not validated.
+template <typename Sink>
+class Transcoder
+{
+public:
+    enum Mode
+    {
+        MINIFY,
+        PRETTY
+    };
+
+    static constexpr size_t default_buffer_size = 64 * 1024;
+
+    explicit Transcoder(Sink sink, Mode mode = MINIFY, size_t indent = 2, size_t bufferSize = default_buffer_size)
+        : sink_(std::move(sink)), mode_(mode), indent_(indent),
+          buf_(std::make_unique<char[]>(bufferSize)), capacity_(bufferSize) {}
+
+    void feed(std::string_view chunk);
+    void feed(std::istream &in);
+    void finish() { flush(); }
+
+    Sink &sink() { return sink_; }
+
+private:
+    Sink sink_;
+    Mode mode_;
+    size_t indent_;
+    std::unique_ptr<char[]> buf_;
+    size_t capacity_;
+    size_t size_ = 0;
+
+    bool inString_ = false;
+    bool escape_ = false;
+    bool pendingOpen_ = false;
+    size_t depth_ = 0;
+
+    enum : uint8_t
+    {
+        WS = 1,
+        QUOTE = 2,
+        STRUCTURAL = 4
+    };
+
+    static constexpr std::array<uint8_t, 256> buildClasses();
+    static const std::array<uint8_t, 256> classes;
+
+    size_t findBoundary(const char *p, size_t i, size_t n) const;
+    static size_t skipWhitespace(const char *p, size_t i, size_t n);
+
+    void put(char c)
+    {
+        if (size_ == capacity_)
+            flush();
+        buf_[size_++] = c;
+    }
+    void put(const char *data, size_t len);
+    void flush()
+    {
+        if (size_ > 0)
+            sink_.write(buf_.get(), size_);
+        size_ = 0;
+    }
+
+    void newline();
+    void beginToken();
+    void structural(char c);
+};
+
+template <typename Sink>
+constexpr std::array<uint8_t, 256> Transcoder<Sink>::buildClasses()
+{
+    std::array<uint8_t, 256> t{};
+    t[' '] = t['\t'] = t['\n'] = t['\r'] = WS;
+    t['"'] = QUOTE;
+    for (unsigned char c : {'{', '}', '[', ']', ',', ':'})
+        t[c] = STRUCTURAL;
+    return t;
+}
+
+template <typename Sink>
+inline const std::array<uint8_t, 256> Transcoder<Sink>::classes = Transcoder<Sink>::buildClasses();
+
+template <typename Sink>
+void Transcoder<Sink>::put(const char *data, size_t len)
+{
+    if (len > capacity_ - size_)
+    {
+        flush();
+        if (len >= capacity_)
+        {
+            sink_.write(data, len);
+            return;
+        }
+    }
+    std::memcpy(buf_.get() + size_, data, len);
+    size_ += len;
+}
+
+// Index of the next whitespace or quote byte (and, when pretty-printing, the
+// next structural byte) in [i, n), or n.
+template <typename Sink>
+size_t Transcoder<Sink>::findBoundary(const char *p, size_t i, size_t n) const
+{
+    const uint8_t stop = mode_ == PRETTY ? (WS | QUOTE | STRUCTURAL) : (WS | QUOTE);
+#if defined(__SSE2__)
+    const bool pretty = mode_ == PRETTY;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        if (pretty)
+        {
+            m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')),
+                                              _mm_cmpeq_epi8(v, _mm_set1_epi8(']'))));
+            m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+                                              _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))));
+            m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')),
+                                              _mm_cmpeq_epi8(v, _mm_set1_epi8(':'))));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask)
+            return i + std::countr_zero(mask);
+    }
+#endif
+    for (; i < n; ++i)
+        if (classes[static_cast<unsigned char>(p[i])] & stop)
+            return i;
+    return n;
+}
+
+template <typename Sink>
+size_t Transcoder<Sink>::skipWhitespace(const char *p, size_t i, size_t n)
+{
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(ws)) & 0xFFFF;
+        if (other)
+            return i + std::countr_zero(other);
+    }
+#endif
+    while (i < n && (classes[static_cast<unsigned char>(p[i])] & WS))
+        ++i;
+    return i;
+}
+
+template <typename Sink>
+void Transcoder<Sink>::newline()
+{
+    put('\n');
+    for (size_t k = 0; k < depth_ * indent_; ++k)
+        put(' ');
+}
+
+template <typename Sink>
+void Transcoder<Sink>::beginToken()
+{
+    if (pendingOpen_)
+    {
+        pendingOpen_ = false;
+        newline();
+    }
+}
+
+template <typename Sink>
+void Transcoder<Sink>::structural(char c)
+{
+    switch (c)
+    {
+    case '{':
+    case '[':
+        beginToken();
+        put(c);
+        ++depth_;
+        pendingOpen_ = true;
+        break;
+    case '}':
+    case ']':
+        if (depth_ > 0)
+            --depth_;
+        if (pendingOpen_)
+            pendingOpen_ = false;
+        else
+            newline();
+        put(c);
+        break;
+    case ',':
+        put(',');
+        newline();
+        break;
+    case ':':
+        put(':');
+        put(' ');
+        break;
+    }
+}
+
+template <typename Sink>
+void Transcoder<Sink>::feed(std::string_view chunk)
+{
+    const char *p = chunk.data();
+    const size_t n = chunk.size();
+    size_t i = 0;
+
+    while (i < n)
+    {
+        if (inString_)
+        {
+            if (escape_)
+            {
+                put(p[i++]);
+                escape_ = false;
+                continue;
+            }
+            bool ascii = true;
+            size_t j = Utf8::findSpecial(p, i, n, ascii);
+            put(p + i, j - i);
+            i = j;
+            if (i == n)
+                break;
+            char c = p[i++];
+            put(c);
+            if (c == '"')
+                inString_ = false;
+            else if (c == '\\')
+                escape_ = true;
+            continue;
+        }
+
+        size_t j = findBoundary(p, i, n);
+        if (j > i)
+        {
+            beginToken();
+            put(p + i, j - i);
+            i = j;
+            if (i == n)
+                break;
+        }
+
+        uint8_t cls = classes[static_cast<unsigned char>(p[i])];
+        if (cls & WS)
+        {
+            i = skipWhitespace(p, i, n);
+        }
+        else if (cls & QUOTE)
+        {
+            beginToken();
+            put(p[i++]);
+            inString_ = true;
+        }
+        else
+        {
+            structural(p[i++]);
+        }
+    }
+}
+
+template <typename Sink>
+void Transcoder<Sink>::feed(std::istream &in)
+{
+    auto chunk = std::make_unique<char[]>(capacity_);
+    while (in)
+    {
+        in.read(chunk.get(), static_cast<std::streamsize>(capacity_));
+        std::streamsize got = in.gcount();
+        if (got <= 0)
+            break;
+        feed(std::string_view(chunk.get(), static_cast<size_t>(got)));
+    }
+}
+
+#endif // TRANSCODER_H
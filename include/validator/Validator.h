@@ -0,0 +1,448 @@
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+struct ValidationResult
+{
+    bool valid;
+    size_t offset;
+
+    explicit operator bool() const { return valid; }
+};
+
+// Byte-level JSON validator. Grammar, string escapes and UTF-8 are all driven
+// by one state x character-class transition table; nesting is tracked in a
+// fixed-size bit stack (1 = object, 0 = array), so validation never allocates.
+class Validator
+{
+public:
+    static constexpr size_t max_supported_depth = 4096;
+
+    explicit Validator(size_t maxDepth = 1024)
+        : maxDepth_(maxDepth < max_supported_depth ? maxDepth : max_supported_depth) {}
+
+    size_t maxDepth() const { return maxDepth_; }
+
+    ValidationResult validate(std::string_view input) const;
+
+private:
+    size_t maxDepth_;
+
+    enum Class : uint8_t
+    {
+        C_SPACE, // ' '
+        C_WHITE, // \t \n \r
+        C_LCURB,
+        C_RCURB,
+        C_LSQRB,
+        C_RSQRB,
+        C_COLON,
+        C_COMMA,
+        C_QUOTE,
+        C_BACKS,
+        C_SLASH,
+        C_PLUS,
+        C_MINUS,
+        C_POINT,
+        C_ZERO,
+        C_DIGIT,
+        C_LOW_A,
+        C_LOW_B,
+        C_LOW_C,
+        C_LOW_D,
+        C_LOW_E,
+        C_LOW_F,
+        C_LOW_L,
+        C_LOW_N,
+        C_LOW_R,
+        C_LOW_S,
+        C_LOW_T,
+        C_LOW_U,
+        C_ABCDF,
+        C_E,
+        C_ETC,   // any other printable ASCII
+        C_CTRL,  // control characters
+        C_80_8F, // UTF-8 continuation bytes, split by the ranges that
+        C_90_9F, // restrict the second byte after E0/ED/F0/F4
+        C_A0_BF,
+        C_C2_DF,
+        C_E0,
+        C_E1_EF, // E1..EC, EE, EF
+        C_ED,
+        C_F0,
+        C_F1_F3,
+        C_F4,
+        C_BAD, // C0, C1, F5..FF
+        NUM_CLASSES
+    };
+
+    enum State : uint8_t
+    {
+        GO, // before the root value
+        OK, // after a value inside a container
+        DN, // after the root value
+        OB, // after '{'
+        KE, // after ',' in an object
+        CO, // after a key
+        VA, // after ':' or ',' in an array
+        AR, // after '['
+        ST, // inside a string
+        ES, // after '\'
+        U1,
+        U2,
+        U3,
+        U4,
+        X1,    // one continuation byte left
+        X2,    // two continuation bytes left
+        X3,    // three continuation bytes left
+        XE0,   // after E0: A0..BF
+        XED,   // after ED: 80..9F
+        XF0,   // after F0: 90..BF
+        XF4,   // after F4: 80..8F
+        MI,    // after '-'
+        ZE,    // after leading '0'
+        IN,    // integer digits
+        FR0,   // after '.'
+        FR,    // fraction digits
+        E1,    // after 'e'
+        E2,    // after exponent sign
+        E3,    // exponent digits
+        T1,
+        T2,
+        T3,
+        F1,
+        F2,
+        F3,
+        F4,
+        N1,
+        N2,
+        N3,
+        NUM_STATES
+    };
+
+    enum Action : uint8_t
+    {
+        A_OBJECT_BEGIN = NUM_STATES,
+        A_ARRAY_BEGIN,
+        A_OBJECT_END,
+        A_ARRAY_END,
+        A_COMMA,
+        A_KEY_BEGIN,
+        A_STRING_BEGIN,
+        A_STRING_END,
+        A_ERROR
+    };
+
+    using ClassTable = std::array<uint8_t, 256>;
+    using TransitionTable = std::array<std::array<uint8_t, NUM_CLASSES>, NUM_STATES>;
+
+    static constexpr ClassTable buildClasses();
+    static constexpr TransitionTable buildTransitions();
+
+    static const ClassTable classes;
+    static const TransitionTable transitions;
+
+    static size_t skipStringRun(const char *p, size_t i, size_t n);
+};
+
+constexpr Validator::ClassTable Validator::buildClasses()
+{
+    ClassTable t{};
+    for (int c = 0; c < 0x20; ++c)
+        t[c] = C_CTRL;
+    for (int c = 0x20; c < 0x80; ++c)
+        t[c] = C_ETC;
+
+    t[' '] = C_SPACE;
+    t['\t'] = t['\n'] = t['\r'] = C_WHITE;
+    t['{'] = C_LCURB;
+    t['}'] = C_RCURB;
+    t['['] = C_LSQRB;
+    t[']'] = C_RSQRB;
+    t[':'] = C_COLON;
+    t[','] = C_COMMA;
+    t['"'] = C_QUOTE;
+    t['\\'] = C_BACKS;
+    t['/'] = C_SLASH;
+    t['+'] = C_PLUS;
+    t['-'] = C_MINUS;
+    t['.'] = C_POINT;
+    t['0'] = C_ZERO;
+    for (int c = '1'; c <= '9'; ++c)
+        t[c] = C_DIGIT;
+    t['a'] = C_LOW_A;
+    t['b'] = C_LOW_B;
+    t['c'] = C_LOW_C;
+    t['d'] = C_LOW_D;
+    t['e'] = C_LOW_E;
+    t['f'] = C_LOW_F;
+    t['l'] = C_LOW_L;
+    t['n'] = C_LOW_N;
+    t['r'] = C_LOW_R;
+    t['s'] = C_LOW_S;
+    t['t'] = C_LOW_T;
+    t['u'] = C_LOW_U;
+    t['A'] = t['B'] = t['C'] = t['D'] = t['F'] = C_ABCDF;
+    t['E'] = C_E;
+
+    for (int c = 0x80; c <= 0x8F; ++c)
+        t[c] = C_80_8F;
+    for (int c = 0x90; c <= 0x9F; ++c)
+        t[c] = C_90_9F;
+    for (int c = 0xA0; c <= 0xBF; ++c)
+        t[c] = C_A0_BF;
+    for (int c = 0xC0; c <= 0xFF; ++c)
+        t[c] = C_BAD;
+    for (int c = 0xC2; c <= 0xDF; ++c)
+        t[c] = C_C2_DF;
+    for (int c = 0xE1; c <= 0xEF; ++c)
+        t[c] = C_E1_EF;
+    t[0xE0] = C_E0;
+    t[0xED] = C_ED;
+    t[0xF0] = C_F0;
+    for (int c = 0xF1; c <= 0xF3; ++c)
+        t[c] = C_F1_F3;
+    t[0xF4] = C_F4;
+    return t;
+}
+
+constexpr Validator::TransitionTable Validator::buildTransitions()
+{
+    TransitionTable t{};
+    for (auto &row : t)
+        row.fill(A_ERROR);
+
+    auto whitespace = [&](State s, uint8_t next)
+    {
+        t[s][C_SPACE] = next;
+        t[s][C_WHITE] = next;
+    };
+    auto value = [&](State s)
+    {
+        t[s][C_LCURB] = A_OBJECT_BEGIN;
+        t[s][C_LSQRB] = A_ARRAY_BEGIN;
+        t[s][C_QUOTE] = A_STRING_BEGIN;
+        t[s][C_MINUS] = MI;
+        t[s][C_ZERO] = ZE;
+        t[s][C_DIGIT] = IN;
+        t[s][C_LOW_T] = T1;
+        t[s][C_LOW_F] = F1;
+        t[s][C_LOW_N] = N1;
+    };
+    auto valueEnd = [&](State s)
+    {
+        whitespace(s, OK);
+        t[s][C_COMMA] = A_COMMA;
+        t[s][C_RCURB] = A_OBJECT_END;
+        t[s][C_RSQRB] = A_ARRAY_END;
+    };
+
+    whitespace(GO, GO);
+    t[GO][C_LCURB] = A_OBJECT_BEGIN;
+    t[GO][C_LSQRB] = A_ARRAY_BEGIN;
+
+    whitespace(OK, OK);
+    t[OK][C_COMMA] = A_COMMA;
+    t[OK][C_RCURB] = A_OBJECT_END;
+    t[OK][C_RSQRB] = A_ARRAY_END;
+
+    whitespace(DN, DN);
+
+    whitespace(OB, OB);
+    t[OB][C_QUOTE] = A_KEY_BEGIN;
+    t[OB][C_RCURB] = A_OBJECT_END;
+
+    whitespace(KE, KE);
+    t[KE][C_QUOTE] = A_KEY_BEGIN;
+
+    whitespace(CO, CO);
+    t[CO][C_COLON] = VA;
+
+    whitespace(VA, VA);
+    value(VA);
+
+    whitespace(AR, AR);
+    value(AR);
+    t[AR][C_RSQRB] = A_ARRAY_END;
+
+    for (int c = 0; c < NUM_CLASSES; ++c)
+        if (c != C_WHITE && c != C_CTRL)
+            t[ST][c] = ST;
+    t[ST][C_QUOTE] = A_STRING_END;
+    t[ST][C_BACKS] = ES;
+    t[ST][C_80_8F] = t[ST][C_90_9F] = t[ST][C_A0_BF] = A_ERROR;
+    t[ST][C_BAD] = A_ERROR;
+    t[ST][C_C2_DF] = X1;
+    t[ST][C_E0] = XE0;
+    t[ST][C_E1_EF] = X2;
+    t[ST][C_ED] = XED;
+    t[ST][C_F0] = XF0;
+    t[ST][C_F1_F3] = X3;
+    t[ST][C_F4] = XF4;
+
+    t[X1][C_80_8F] = t[X1][C_90_9F] = t[X1][C_A0_BF] = ST;
+    t[X2][C_80_8F] = t[X2][C_90_9F] = t[X2][C_A0_BF] = X1;
+    t[X3][C_80_8F] = t[X3][C_90_9F] = t[X3][C_A0_BF] = X2;
+    t[XE0][C_A0_BF] = X1;
+    t[XED][C_80_8F] = t[XED][C_90_9F] = X1;
+    t[XF0][C_90_9F] = t[XF0][C_A0_BF] = X2;
+    t[XF4][C_80_8F] = X2;
+
+    for (int c : {C_QUOTE, C_BACKS, C_SLASH, C_LOW_B, C_LOW_F, C_LOW_N, C_LOW_R, C_LOW_T})
+        t[ES][c] = ST;
+    t[ES][C_LOW_U] = U1;
+
+    const State hex[] = {U1, U2, U3, U4};
+    const State after[] = {U2, U3, U4, ST};
+    for (int i = 0; i < 4; ++i)
+        for (int c : {C_ZERO, C_DIGIT, C_LOW_A, C_LOW_B, C_LOW_C, C_LOW_D, C_LOW_E, C_LOW_F, C_ABCDF, C_E})
+            t[hex[i]][c] = after[i];
+
+    t[MI][C_ZERO] = ZE;
+    t[MI][C_DIGIT] = IN;
+
+    valueEnd(ZE);
+    t[ZE][C_POINT] = FR0;
+    t[ZE][C_LOW_E] = t[ZE][C_E] = E1;
+
+    valueEnd(IN);
+    t[IN][C_ZERO] = t[IN][C_DIGIT] = IN;
+    t[IN][C_POINT] = FR0;
+    t[IN][C_LOW_E] = t[IN][C_E] = E1;
+
+    t[FR0][C_ZERO] = t[FR0][C_DIGIT] = FR;
+
+    valueEnd(FR);
+    t[FR][C_ZERO] = t[FR][C_DIGIT] = FR;
+    t[FR][C_LOW_E] = t[FR][C_E] = E1;
+
+    t[E1][C_PLUS] = t[E1][C_MINUS] = E2;
+    t[E1][C_ZERO] = t[E1][C_DIGIT] = E3;
+    t[E2][C_ZERO] = t[E2][C_DIGIT] = E3;
+
+    valueEnd(E3);
+    t[E3][C_ZERO] = t[E3][C_DIGIT] = E3;
+
+    t[T1][C_LOW_R] = T2;
+    t[T2][C_LOW_U] = T3;
+    t[T3][C_LOW_E] = OK;
+    t[F1][C_LOW_A] = F2;
+    t[F2][C_LOW_L] = F3;
+    t[F3][C_LOW_S] = F4;
+    t[F4][C_LOW_E] = OK;
+    t[N1][C_LOW_U] = N2;
+    t[N2][C_LOW_L] = N3;
+    t[N3][C_LOW_L] = OK;
+
+    return t;
+}
+
+inline const Validator::ClassTable Validator::classes = Validator::buildClasses();
+inline const Validator::TransitionTable Validator::transitions = Validator::buildTransitions();
+
+// Skips plain ASCII string content eight bytes at a time; stops at the first
+// word containing a quote, backslash, control or non-ASCII byte.
+inline size_t Validator::skipStringRun(const char *p, size_t i, size_t n)
+{
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    constexpr uint64_t highs = 0x8080808080808080ULL;
+
+    while (i + 8 <= n)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        uint64_t quote = w ^ (ones * '"');
+        uint64_t backslash = w ^ (ones * '\\');
+        uint64_t special = ((quote - ones) & ~quote) |
+                           ((backslash - ones) & ~backslash) |
+                           (w - ones * 0x20) | w;
+        if (special & highs)
+            break;
+        i += 8;
+    }
+    return i;
+}
+
+inline ValidationResult Validator::validate(std::string_view input) const
+{
+    std::array<uint64_t, max_supported_depth / 64> stack;
+    size_t depth = 0;
+    uint8_t state = GO;
+    uint8_t afterString = OK;
+
+    const char *p = input.data();
+    const size_t n = input.size();
+
+    auto top = [&]()
+    { return (stack[(depth - 1) / 64] >> ((depth - 1) % 64)) & 1; };
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (state == ST)
+        {
+            i = skipStringRun(p, i, n);
+            if (i == n)
+                break;
+        }
+
+        uint8_t next = transitions[state][classes[static_cast<unsigned char>(p[i])]];
+        if (next < NUM_STATES)
+        {
+            state = next;
+            continue;
+        }
+
+        switch (next)
+        {
+        case A_OBJECT_BEGIN:
+        case A_ARRAY_BEGIN:
+        {
+            if (depth == maxDepth_)
+                return {false, i};
+            uint64_t bit = uint64_t(1) << (depth % 64);
+            if (next == A_OBJECT_BEGIN)
+                stack[depth / 64] |= bit;
+            else
+                stack[depth / 64] &= ~bit;
+            ++depth;
+            state = next == A_OBJECT_BEGIN ? OB : AR;
+            break;
+        }
+        case A_OBJECT_END:
+        case A_ARRAY_END:
+            if (depth == 0 || top() != (next == A_OBJECT_END ? 1u : 0u))
+                return {false, i};
+            --depth;
+            state = depth == 0 ? DN : OK;
+            break;
+        case A_COMMA:
+            if (depth == 0)
+                return {false, i};
+            state = top() ? KE : VA;
+            break;
+        case A_KEY_BEGIN:
+            afterString = CO;
+            state = ST;
+            break;
+        case A_STRING_BEGIN:
+            afterString = OK;
+            state = ST;
+            break;
+        case A_STRING_END:
+            state = afterString;
+            break;
+        default:
+            return {false, i};
+        }
+    }
+
+    if (state != DN)
+        return {false, n};
+    return {true, n};
+}
+
+#endif // VALIDATOR_H
@@ -0,0 +1,354 @@
+#ifndef PARALLELSERIALIZER_H
+#define PARALLELSERIALIZER_H
+
+#include "io/Sink.h"
+#include "json/Config.h"
+#include "json/Json.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Serializes a document on several threads. Containers holding more than
+// chunkSize values are cut into ranges of elements (descending into large
+// children), each range is printed into its own buffer by a worker, and the
+// buffers are emitted in order. The output is byte-identical to operator<<
+// on a default-formatted stream.
+class ParallelSerializer
+{
+public:
+    static constexpr size_t default_chunk_size = 4096;
+
+    explicit ParallelSerializer(size_t threads = 0, size_t chunkSize = default_chunk_size)
+        : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          chunkSize_(std::max<size_t>(chunkSize, 1)) {}
+
+    // Ordered output buffers; their concatenation is the serialized document.
+    std::vector<std::string> serialize(const Json &json);
+    std::vector<std::string> serialize(const JsonValue &value);
+
+    std::string dump(const Json &json);
+    std::string dump(const JsonValue &value);
+
+    template <typename Sink>
+    void write(const Json &json, Sink &sink);
+    template <typename Sink>
+    void write(const JsonValue &value, Sink &sink);
+
+    size_t threads() const { return threads_; }
+    size_t chunkSize() const { return chunkSize_; }
+
+private:
+    using entry_t = std::pair<const std::string, JsonValue>;
+
+    // A piece of output: literal text, a range of array elements, a range
+    // of a packed array starting at offset or a range of object entries.
+    // Ranges after the first in their container are preceded by the ", "
+    // separator.
+    struct Task
+    {
+        std::string text;
+        const JsonValue *elements = nullptr;
+        const JsonValue *packed = nullptr;
+        size_t offset = 0;
+        std::vector<const entry_t *> entries;
+        size_t count = 0;
+        bool separator = false;
+    };
+
+    size_t threads_;
+    size_t chunkSize_;
+    std::vector<Task> tasks_;
+
+    void literal(std::string_view text);
+    static size_t weigh(const JsonValue &value, size_t limit);
+    void plan(const JsonValue &value);
+    void planArray(const JsonValue::array_t &arr);
+    void planPacked(const JsonValue &value, size_t size);
+    void planObject(const Json &obj);
+    std::vector<std::string> run();
+    static void print(Task &task);
+
+    static std::string join(std::vector<std::string> parts);
+    template <typename Sink>
+    static void emit(std::vector<std::string> parts, Sink &sink);
+};
+
+inline std::vector<std::string> ParallelSerializer::serialize(const Json &json)
+{
+    tasks_.clear();
+    planObject(json);
+    return run();
+}
+
+inline std::vector<std::string> ParallelSerializer::serialize(const JsonValue &value)
+{
+    tasks_.clear();
+    plan(value);
+    return run();
+}
+
+inline std::string ParallelSerializer::dump(const Json &json)
+{
+    return join(serialize(json));
+}
+
+inline std::string ParallelSerializer::dump(const JsonValue &value)
+{
+    return join(serialize(value));
+}
+
+template <typename Sink>
+void ParallelSerializer::write(const Json &json, Sink &sink)
+{
+    emit(serialize(json), sink);
+}
+
+template <typename Sink>
+void ParallelSerializer::write(const JsonValue &value, Sink &sink)
+{
+    emit(serialize(value), sink);
+}
+
+inline std::string ParallelSerializer::join(std::vector<std::string> parts)
+{
+    size_t total = 0;
+    for (const auto &p : parts)
+        total += p.size();
+
+    std::string out;
+    out.reserve(total);
+    for (const auto &p : parts)
+        out += p;
+    return out;
+}
+
+template <typename Sink>
+void ParallelSerializer::emit(std::vector<std::string> parts, Sink &sink)
+{
+    if constexpr (requires(const std::string_view *v, size_t n) { sink.writev(v, n); })
+    {
+        std::vector<std::string_view> views(parts.begin(), parts.end());
+        sink.writev(views.data(), views.size());
+    }
+    else
+    {
+        for (const auto &p : parts)
+            sink.write(p.data(), p.size());
+    }
+}
+
+inline void ParallelSerializer::literal(std::string_view text)
+{
+    if (tasks_.empty() || tasks_.back().count > 0)
+        tasks_.emplace_back();
+    tasks_.back().text += text;
+}
+
+// Number of values in the subtree, counting stops once it exceeds limit.
+inline size_t ParallelSerializer::weigh(const JsonValue &value, size_t limit)
+{
+    size_t weight = 1;
+    if (value.is_packed<JsonValue::number_integer_t>())
+        weight += value.packed<JsonValue::number_integer_t>().size();
+    else if (value.is_packed<JsonValue::number_float_t>())
+        weight += value.packed<JsonValue::number_float_t>().size();
+    else if (value.is_array())
+    {
+        for (const auto &v : value.get<JsonValue::array_t>())
+        {
+            weight += weigh(v, limit - std::min(weight, limit));
+            if (weight > limit)
+                break;
+        }
+    }
+    else if (value.is_object())
+    {
+        for (const auto &kv : value.get<JsonValue::object_t>())
+        {
+            weight += weigh(kv.second, limit - std::min(weight, limit));
+            if (weight > limit)
+                break;
+        }
+    }
+    return weight;
+}
+
+inline void ParallelSerializer::plan(const JsonValue &value)
+{
+    size_t weight = weigh(value, chunkSize_);
+    if (weight <= chunkSize_)
+    {
+        Task &task = tasks_.emplace_back();
+        task.elements = &value;
+        task.count = 1;
+    }
+    else if (value.is_packed())
+    {
+        planPacked(value, weight - 1);
+    }
+    else if (value.is_array())
+    {
+        planArray(value.get<JsonValue::array_t>());
+    }
+    else
+    {
+        planObject(value.get<JsonValue::object_t>());
+    }
+}
+
+// Light elements are grouped into ranges of about chunkSize values; heavy
+// ones are planned on their own so their contents are split further.
+inline void ParallelSerializer::planArray(const JsonValue::array_t &arr)
+{
+    literal("[");
+    Task *task = nullptr;
+    size_t weight = 0;
+    for (size_t i = 0; i < arr.size(); ++i)
+    {
+        size_t w = weigh(arr[i], chunkSize_);
+        if (w > chunkSize_)
+        {
+            if (i > 0)
+                literal(", ");
+            plan(arr[i]);
+            task = nullptr;
+            continue;
+        }
+
+        if (!task || weight >= chunkSize_)
+        {
+            task = &tasks_.emplace_back();
+            task->elements = &arr[i];
+            task->separator = i > 0;
+            weight = 0;
+        }
+        ++task->count;
+        weight += w;
+    }
+    literal("]");
+}
+
+inline void ParallelSerializer::planPacked(const JsonValue &value, size_t size)
+{
+    literal("[");
+    for (size_t i = 0; i < size; i += chunkSize_)
+    {
+        Task &task = tasks_.emplace_back();
+        task.packed = &value;
+        task.offset = i;
+        task.count = std::min(chunkSize_, size - i);
+        task.separator = i > 0;
+    }
+    literal("]");
+}
+
+inline void ParallelSerializer::planObject(const Json &obj)
+{
+    literal("{");
+    bool first = true;
+    Task *task = nullptr;
+    size_t weight = 0;
+    for (const auto &kv : obj)
+    {
+        size_t w = weigh(kv.second, chunkSize_);
+        if (w > chunkSize_)
+        {
+            literal((first ? "\"" : ", \"") + kv.first + "\": ");
+            plan(kv.second);
+            task = nullptr;
+        }
+        else
+        {
+            if (!task || weight >= chunkSize_)
+            {
+                task = &tasks_.emplace_back();
+                task->separator = !first;
+                weight = 0;
+            }
+            task->entries.push_back(&kv);
+            task->count = task->entries.size();
+            weight += w;
+        }
+        first = false;
+    }
+    literal("}");
+}
+
+inline void ParallelSerializer::print(Task &task)
+{
+    if (task.count == 0)
+        return;
+
+    std::ostringstream os;
+    if (task.separator)
+        os << ", ";
+    for (size_t i = 0; i < task.count; ++i)
+    {
+        if (i > 0)
+            os << ", ";
+        if (task.packed && task.packed->is_packed<JsonValue::number_integer_t>())
+            os << task.packed->packed<JsonValue::number_integer_t>()[task.offset + i];
+        else if (task.packed)
+            os << task.packed->packed<JsonValue::number_float_t>()[task.offset + i];
+        else if (task.elements)
+            os << task.elements[i];
+        else
+            os << '\"' << task.entries[i]->first << "\": " << task.entries[i]->second;
+    }
+    task.text = std::move(os).str();
+}
+
+inline std::vector<std::string> ParallelSerializer::run()
+{
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+
+    auto worker = [&]()
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < tasks_.size();)
+        {
+            if (failed.load(std::memory_order_relaxed))
+                return;
+            LIBJSON_TRY
+            {
+                print(tasks_[i]);
+            }
+            LIBJSON_CATCH(...)
+            {
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+                return;
+            }
+        }
+    };
+
+    size_t work = 0;
+    for (const auto &task : tasks_)
+        work += task.count > 0;
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::min(threads_, work); ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    std::vector<std::string> parts;
+    parts.reserve(tasks_.size());
+    for (auto &task : tasks_)
+        parts.push_back(std::move(task.text));
+    tasks_.clear();
+    return parts;
+}
+
+#endif // PARALLELSERIALIZER_H
@@ -0,0 +1,454 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "io/Sink.h"
+#include "json/Config.h"
+#include "json/Json.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Incremental JSON writer. Output is assembled in a fixed-size buffer that is
+// handed to the sink whenever it fills, so memory use does not depend on the
+// size of the document. Nesting and key/value order are checked as calls are
+// made; misuse throws std::logic_error. Strings are expected to be UTF-8 and
+// raw() text is written verbatim.
+template <typename Sink>
+class Writer
+{
+public:
+    static constexpr size_t default_buffer_size = 64 * 1024;
+    static constexpr size_t min_buffer_size = 64;
+
+    explicit Writer(Sink sink, size_t bufferSize = default_buffer_size)
+        : sink_(std::move(sink)), capacity_(std::max(bufferSize, min_buffer_size)),
+          buf_(std::make_unique<char[]>(capacity_)) {}
+
+    Writer &begin_object();
+    Writer &end_object();
+    Writer &begin_array();
+    Writer &end_array();
+
+    Writer &key(std::string_view k);
+
+    Writer &value(std::nullptr_t);
+    Writer &value(bool b);
+    Writer &value(const char *s) { return value(std::string_view(s)); }
+    Writer &value(const std::string &s) { return value(std::string_view(s)); }
+    Writer &value(std::string_view s);
+    Writer &value(const JsonNumber &n) { return raw(n.raw()); }
+    Writer &value(const Json &obj);
+    Writer &value(const JsonValue &v);
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    Writer &value(T n);
+
+    template <typename T>
+        requires std::is_floating_point_v<T>
+    Writer &value(T n);
+
+    // Writes an already serialized value.
+    Writer &raw(std::string_view json);
+
+    // True once a complete top-level value has been written.
+    bool complete() const { return done_; }
+    size_t depth() const { return depth_; }
+
+    void flush();
+    void finish();
+
+    Sink &sink() { return sink_; }
+
+private:
+    Sink sink_;
+    size_t capacity_;
+    std::unique_ptr<char[]> buf_;
+    size_t size_ = 0;
+
+    // One bit per open container, set for objects.
+    std::vector<uint64_t> stack_;
+    size_t depth_ = 0;
+    bool first_ = true;
+    bool expectKey_ = false;
+    bool done_ = false;
+
+    bool inObject() const { return depth_ > 0 && (stack_[(depth_ - 1) / 64] >> ((depth_ - 1) % 64) & 1); }
+
+    void beforeValue();
+    void afterValue();
+    void open(bool object, char c);
+    void close(bool object, char c);
+
+    void put(char c)
+    {
+        if (size_ == capacity_)
+            flush();
+        buf_[size_++] = c;
+    }
+    void put(const char *data, size_t len);
+    char *reserve(size_t len)
+    {
+        if (capacity_ - size_ < len)
+            flush();
+        return buf_.get() + size_;
+    }
+
+    void writeString(std::string_view s);
+    static size_t findEscape(const char *p, size_t i, size_t n);
+
+    static constexpr std::array<char, 256> buildEscapes();
+    static const std::array<char, 256> escapes;
+};
+
+// Second byte of the escape sequence for each byte, 'u' for \u00XX, or 0 if
+// the byte is copied as is.
+template <typename Sink>
+constexpr std::array<char, 256> Writer<Sink>::buildEscapes()
+{
+    std::array<char, 256> t{};
+    for (size_t c = 0; c < 0x20; ++c)
+        t[c] = 'u';
+    t['\b'] = 'b';
+    t['\f'] = 'f';
+    t['\n'] = 'n';
+    t['\r'] = 'r';
+    t['\t'] = 't';
+    t['"'] = '"';
+    t['\\'] = '\\';
+    return t;
+}
+
+template <typename Sink>
+inline const std::array<char, 256> Writer<Sink>::escapes = Writer<Sink>::buildEscapes();
+
+template <typename Sink>
+void Writer<Sink>::put(const char *data, size_t len)
+{
+    if (len > capacity_ - size_)
+    {
+        flush();
+        if (len >= capacity_)
+        {
+            sink_.write(data, len);
+            return;
+        }
+    }
+    std::memcpy(buf_.get() + size_, data, len);
+    size_ += len;
+}
+
+template <typename Sink>
+void Writer<Sink>::flush()
+{
+    if (size_ > 0)
+        sink_.write(buf_.get(), size_);
+    size_ = 0;
+}
+
+template <typename Sink>
+void Writer<Sink>::finish()
+{
+    if (!done_)
+        LIBJSON_THROW(std::logic_error("Writer finished with an incomplete document"));
+    flush();
+}
+
+template <typename Sink>
+void Writer<Sink>::beforeValue()
+{
+    if (depth_ == 0)
+    {
+        if (done_)
+            LIBJSON_THROW(std::logic_error("Writer already holds a complete document"));
+        return;
+    }
+    if (inObject())
+    {
+        if (expectKey_)
+            LIBJSON_THROW(std::logic_error("Expected a key inside object"));
+        return;
+    }
+    if (!first_)
+        put(',');
+}
+
+template <typename Sink>
+void Writer<Sink>::afterValue()
+{
+    if (depth_ == 0)
+    {
+        done_ = true;
+        return;
+    }
+    first_ = false;
+    expectKey_ = inObject();
+}
+
+template <typename Sink>
+void Writer<Sink>::open(bool object, char c)
+{
+    beforeValue();
+    put(c);
+    if (depth_ / 64 >= stack_.size())
+        stack_.push_back(0);
+    uint64_t bit = uint64_t(1) << (depth_ % 64);
+    if (object)
+        stack_[depth_ / 64] |= bit;
+    else
+        stack_[depth_ / 64] &= ~bit;
+    ++depth_;
+    first_ = true;
+    expectKey_ = object;
+}
+
+template <typename Sink>
+void Writer<Sink>::close(bool object, char c)
+{
+    if (depth_ == 0 || inObject() != object)
+        LIBJSON_THROW(std::logic_error(object ? "end_object() without matching begin_object()"
+                                              : "end_array() without matching begin_array()"));
+    if (object && !expectKey_)
+        LIBJSON_THROW(std::logic_error("Key without value at end of object"));
+    put(c);
+    --depth_;
+    afterValue();
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::begin_object()
+{
+    open(true, '{');
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::end_object()
+{
+    close(true, '}');
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::begin_array()
+{
+    open(false, '[');
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::end_array()
+{
+    close(false, ']');
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::key(std::string_view k)
+{
+    if (!inObject() || !expectKey_)
+        LIBJSON_THROW(std::logic_error("key() is only valid where an object expects a key"));
+    if (!first_)
+        put(',');
+    writeString(k);
+    put(':');
+    expectKey_ = false;
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::value(std::nullptr_t)
+{
+    return raw("null");
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::value(bool b)
+{
+    return raw(b ? std::string_view("true") : std::string_view("false"));
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::value(std::string_view s)
+{
+    beforeValue();
+    writeString(s);
+    afterValue();
+    return *this;
+}
+
+template <typename Sink>
+template <typename T>
+    requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+Writer<Sink> &Writer<Sink>::value(T n)
+{
+    beforeValue();
+    char *p = reserve(48);
+    size_ += static_cast<size_t>(std::to_chars(p, p + 48, n).ptr - p);
+    afterValue();
+    return *this;
+}
+
+template <typename Sink>
+template <typename T>
+    requires std::is_floating_point_v<T>
+Writer<Sink> &Writer<Sink>::value(T n)
+{
+    if (!std::isfinite(n))
+        LIBJSON_THROW(std::invalid_argument("JSON cannot represent NaN or infinity"));
+    beforeValue();
+    char *p = reserve(48);
+    size_ += static_cast<size_t>(std::to_chars(p, p + 48, n).ptr - p);
+    afterValue();
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::raw(std::string_view json)
+{
+    beforeValue();
+    put(json.data(), json.size());
+    afterValue();
+    return *this;
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::value(const Json &obj)
+{
+    begin_object();
+    for (const auto &kv : obj)
+    {
+        key(kv.first);
+        value(kv.second);
+    }
+    return end_object();
+}
+
+template <typename Sink>
+Writer<Sink> &Writer<Sink>::value(const JsonValue &v)
+{
+    if (v.is_null())
+        return value(nullptr);
+    if (v.is_boolean())
+        return value(v.get<JsonValue::boolean_t>());
+    if (v.is_integer())
+        return value(v.get<JsonValue::number_integer_t>());
+    if (v.is_float())
+        return value(v.get<JsonValue::number_float_t>());
+    if (v.is_raw_number())
+        return value(v.get<JsonValue::number_raw_t>());
+    if (v.is_string())
+        return value(std::string_view(v.get<JsonValue::string_t>()));
+    if (v.is_packed())
+    {
+        begin_array();
+        if (v.is_packed<JsonValue::number_integer_t>())
+            for (auto n : v.packed<JsonValue::number_integer_t>())
+                value(n);
+        else
+            for (auto n : v.packed<JsonValue::number_float_t>())
+                value(n);
+        return end_array();
+    }
+    if (v.is_array())
+    {
+        begin_array();
+        for (const auto &e : v.get<JsonValue::array_t>())
+            value(e);
+        return end_array();
+    }
+    return value(v.get<JsonValue::object_t>());
+}
+
+// Index of the next byte in [i, n) that must be escaped, or n.
+template <typename Sink>
+size_t Writer<Sink>::findEscape(const char *p, size_t i, size_t n)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask)
+            return i + std::countr_zero(mask);
+    }
+#else
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    constexpr uint64_t highs = 0x8080808080808080ULL;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        uint64_t quote = w ^ (ones * '"');
+        uint64_t backslash = w ^ (ones * '\\');
+        uint64_t hit = ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | ((w - ones * 0x20) & ~w);
+        if (hit & highs)
+            break;
+    }
+#endif
+    for (; i < n; ++i)
+        if (escapes[static_cast<unsigned char>(p[i])])
+            return i;
+    return n;
+}
+
+template <typename Sink>
+void Writer<Sink>::writeString(std::string_view s)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    put('"');
+    const char *p = s.data();
+    const size_t n = s.size();
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t j = findEscape(p, i, n);
+        put(p + i, j - i);
+        if (j == n)
+            break;
+
+        unsigned char c = static_cast<unsigned char>(p[j]);
+        char e = escapes[c];
+        char *out = reserve(6);
+        out[0] = '\\';
+        out[1] = e;
+        if (e == 'u')
+        {
+            out[2] = '0';
+            out[3] = '0';
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0xF];
+            size_ += 6;
+        }
+        else
+        {
+            size_ += 2;
+        }
+        i = j + 1;
+    }
+    put('"');
+}
+
+#endif // WRITER_H
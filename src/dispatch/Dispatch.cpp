@@ -0,0 +1,126 @@
+#include "dispatch/Dispatch.h"
+
+// LIBJSON_KERNEL_<ISA> marks the variants CMake built for this target.
+namespace libjson_baseline
+{
+extern const Dispatch::Kernels kernels;
+}
+#if defined(LIBJSON_KERNEL_SSE42)
+namespace libjson_sse42
+{
+extern const Dispatch::Kernels kernels;
+}
+#endif
+#if defined(LIBJSON_KERNEL_AVX2)
+namespace libjson_avx2
+{
+extern const Dispatch::Kernels kernels;
+}
+#endif
+#if defined(LIBJSON_KERNEL_AVX512)
+namespace libjson_avx512
+{
+extern const Dispatch::Kernels kernels;
+}
+#endif
+
+namespace
+{
+
+const Dispatch::Kernels *variant(Dispatch::Isa isa)
+{
+    switch (isa)
+    {
+#if defined(LIBJSON_KERNEL_SSE42)
+    case Dispatch::SSE42:
+        return &libjson_sse42::kernels;
+#endif
+#if defined(LIBJSON_KERNEL_AVX2)
+    case Dispatch::AVX2:
+        return &libjson_avx2::kernels;
+#endif
+#if defined(LIBJSON_KERNEL_AVX512)
+    case Dispatch::AVX512:
+        return &libjson_avx512::kernels;
+#endif
+    case Dispatch::BASELINE:
+        return &libjson_baseline::kernels;
+    default:
+        return nullptr;
+    }
+}
+
+// Mirrors the -m flags each variant is compiled with; __builtin_cpu_supports
+// also checks that the OS saves the wider registers.
+bool cpuSupports(Dispatch::Isa isa)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    switch (isa)
+    {
+    case Dispatch::BASELINE:
+        return true;
+    case Dispatch::SSE42:
+        return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+    case Dispatch::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") &&
+               __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt");
+    case Dispatch::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("bmi2");
+    }
+    return false;
+#else
+    return isa == Dispatch::BASELINE;
+#endif
+}
+
+} // namespace
+
+// Constant-initialised, so kernels are usable from other static
+// initialisers even before the selection below has run.
+std::atomic<const Dispatch::Kernels *> Dispatch::active_{&libjson_baseline::kernels};
+
+namespace
+{
+
+[[maybe_unused]] const bool selected = Dispatch::select(Dispatch::detect());
+
+} // namespace
+
+const char *Dispatch::name(Isa isa)
+{
+    switch (isa)
+    {
+    case BASELINE:
+        return "baseline";
+    case SSE42:
+        return "sse4.2";
+    case AVX2:
+        return "avx2";
+    case AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+bool Dispatch::supported(Isa isa)
+{
+    return variant(isa) != nullptr && cpuSupports(isa);
+}
+
+Dispatch::Isa Dispatch::detect()
+{
+    for (Isa isa : {AVX512, AVX2, SSE42})
+        if (supported(isa))
+            return isa;
+    return BASELINE;
+}
+
+bool Dispatch::select(Isa isa)
+{
+    if (!supported(isa))
+        return false;
+    active_.store(variant(isa), std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,19 @@
+// One kernel variant of the compiled library. CMake builds this file once
+// per instruction set with the matching -m flags and
+// LIBJSON_KERNEL_NAMESPACE=libjson_<isa>, LIBJSON_KERNEL_ISA=<ISA>.
+
+#include "dispatch/Dispatch.h"
+#include "lexer/Utf8.h"
+
+namespace LIBJSON_KERNEL_NAMESPACE
+{
+
+extern const Dispatch::Kernels kernels;
+
+const Dispatch::Kernels kernels = {
+    Dispatch::LIBJSON_KERNEL_ISA,
+    &Utf8::validate,
+    &Utf8::findSpecial,
+};
+
+} // namespace LIBJSON_KERNEL_NAMESPACE
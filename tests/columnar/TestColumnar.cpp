@@ -0,0 +1,125 @@
+#include "columnar/Columnar.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+TEST(ColumnarTest, ConvertsTypedColumnsWithValidity)
+{
+    ColumnSchema schema{{"id", ColumnSchema::INTEGER},
+                        {"score", ColumnSchema::FLOAT},
+                        {"ok", ColumnSchema::BOOLEAN},
+                        {"name", ColumnSchema::STRING}};
+    ColumnarConverter converter(schema, 1);
+    ColumnBatch batch = converter.convertBatch(
+        "{\"id\": 1, \"score\": 2.5, \"ok\": true, \"name\": \"a\", \"extra\": {\"x\": [1, 2]}}\n"
+        "\n"
+        "{\"name\": \"caf\\u00e9\", \"id\": null, \"score\": 3}\r\n"
+        "{}\n");
+
+    ASSERT_EQ(batch.rows, 3u);
+    const Column &id = batch.columns[0];
+    const Column &score = batch.columns[1];
+    const Column &ok = batch.columns[2];
+    const Column &name = batch.columns[3];
+
+    EXPECT_EQ(id.integers, (std::vector<int64_t>{1, 0, 0}));
+    EXPECT_TRUE(id.valid(0));
+    EXPECT_FALSE(id.valid(1));
+    EXPECT_EQ(id.null_count(), 2u);
+
+    EXPECT_EQ(score.floats, (std::vector<double>{2.5, 3.0, 0.0}));
+    EXPECT_EQ(ok.booleans, (std::vector<uint8_t>{1, 0, 0}));
+    EXPECT_EQ(ok.null_count(), 2u);
+
+    EXPECT_EQ(name.offsets.size(), 4u);
+    EXPECT_EQ(name.string(0), "a");
+    EXPECT_EQ(name.string(1), "caf\xC3\xA9");
+    EXPECT_EQ(name.string(2), "");
+    EXPECT_FALSE(name.valid(2));
+}
+
+TEST(ColumnarTest, StringColumnsKeepJsonTextOfOtherValues)
+{
+    ColumnarConverter converter(ColumnSchema{{"v", ColumnSchema::STRING}}, 1);
+    ColumnBatch batch = converter.convertBatch("{\"v\": 12.50}\n{\"v\": false}\n{\"v\": [1, {\"a\": \"]\"}]}\n");
+    const Column &v = batch.columns[0];
+    EXPECT_EQ(v.string(0), "12.50");
+    EXPECT_EQ(v.string(1), "false");
+    EXPECT_EQ(v.string(2), "[1, {\"a\": \"]\"}]");
+}
+
+TEST(ColumnarTest, LastDuplicateKeyWins)
+{
+    ColumnarConverter converter(ColumnSchema{{"a", ColumnSchema::STRING}, {"b", ColumnSchema::INTEGER}}, 1);
+    ColumnBatch batch = converter.convertBatch("{\"a\": \"first\", \"b\": 1, \"a\": \"second\", \"b\": null}\n{\"a\": \"x\"}");
+    ASSERT_EQ(batch.rows, 2u);
+    EXPECT_EQ(batch.columns[0].string(0), "second");
+    EXPECT_EQ(batch.columns[0].string(1), "x");
+    EXPECT_EQ(batch.columns[0].bytes, "secondx");
+    EXPECT_FALSE(batch.columns[1].valid(0));
+    EXPECT_EQ(batch.columns[1].rows, 2u);
+}
+
+TEST(ColumnarTest, ErrorsNameTheLine)
+{
+    ColumnarConverter converter(ColumnSchema{{"a", ColumnSchema::INTEGER}}, 1);
+    try
+    {
+        converter.convert("{\"a\": 1}\n{\"a\": 2}\n{\"a\": \"x\"}\n");
+        FAIL() << "expected an exception";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_NE(std::string(e.what()).find("line 3"), std::string::npos) << e.what();
+    }
+    EXPECT_THROW(converter.convert("{\"a\": 1} x\n"), std::runtime_error);
+    EXPECT_THROW(converter.convert("[1]\n"), std::runtime_error);
+    EXPECT_THROW(converter.convert("{\"a\": 1.5}\n"), std::runtime_error);
+    EXPECT_THROW(converter.convert("{\"a\" 1}\n"), std::runtime_error);
+    EXPECT_THROW(ColumnSchema({{"a", ColumnSchema::INTEGER}, {"a", ColumnSchema::FLOAT}}), std::invalid_argument);
+}
+
+TEST(ColumnarTest, InfersSchemaInFirstSeenOrder)
+{
+    ColumnSchema schema = ColumnarConverter::infer(
+        "{\"id\": 1, \"x\": 1, \"tag\": \"a\", \"flag\": true, \"mixed\": 1, \"nested\": {}, \"nil\": null}\n"
+        "{\"id\": 2, \"x\": 1.5, \"mixed\": \"s\"}\n");
+    ASSERT_EQ(schema.size(), 7u);
+    EXPECT_EQ(schema.fields()[0].name, "id");
+    EXPECT_EQ(schema.fields()[0].type, ColumnSchema::INTEGER);
+    EXPECT_EQ(schema.fields()[1].type, ColumnSchema::FLOAT);
+    EXPECT_EQ(schema.fields()[2].type, ColumnSchema::STRING);
+    EXPECT_EQ(schema.fields()[3].type, ColumnSchema::BOOLEAN);
+    EXPECT_EQ(schema.fields()[4].type, ColumnSchema::STRING);
+    EXPECT_EQ(schema.fields()[5].type, ColumnSchema::STRING);
+    EXPECT_EQ(schema.fields()[6].name, "nil");
+    EXPECT_EQ(schema.index("tag"), 2u);
+    EXPECT_EQ(schema.index("missing"), ColumnSchema::npos);
+}
+
+TEST(ColumnarTest, ParallelBatchesMatchSequentialConversion)
+{
+    std::string input;
+    for (int i = 0; i < 1000; ++i)
+        input += "{\"id\": " + std::to_string(i) + ", \"name\": \"n" + std::to_string(i) + "\"}\n";
+
+    ColumnSchema schema = ColumnarConverter::infer(input);
+    ColumnarConverter parallel(schema, 4, 64);
+    std::vector<ColumnBatch> batches = parallel.convert(input);
+    ASSERT_EQ(batches.size(), 16u);
+
+    size_t row = 0;
+    for (auto &batch : batches)
+    {
+        EXPECT_EQ(batch.firstLine, row + 1);
+        std::vector<int64_t> ids = std::move(batch.columns[0].integers);
+        for (size_t r = 0; r < batch.rows; ++r, ++row)
+        {
+            EXPECT_EQ(ids[r], static_cast<int64_t>(row));
+            EXPECT_EQ(batch.columns[1].string(r), "n" + std::to_string(row));
+        }
+    }
+    EXPECT_EQ(row, 1000u);
+}
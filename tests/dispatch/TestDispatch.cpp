@@ -0,0 +1,185 @@
+#include "dispatch/Dispatch.h"
+#include "lexer/Utf8.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::vector<Dispatch::Isa> supportedIsas()
+{
+    std::vector<Dispatch::Isa> out;
+    for (Dispatch::Isa isa : {Dispatch::BASELINE, Dispatch::SSE42, Dispatch::AVX2, Dispatch::AVX512})
+        if (Dispatch::supported(isa))
+            out.push_back(isa);
+    return out;
+}
+
+// Restores the load-time selection when a test switches kernels.
+struct ScopedIsa
+{
+    Dispatch::Isa saved = Dispatch::isa();
+    ~ScopedIsa() { Dispatch::select(saved); }
+};
+
+// Mixed ASCII, multi-byte UTF-8, quotes, backslashes and control characters
+// at every alignment.
+std::vector<std::string> samples()
+{
+    std::vector<std::string> out;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    const std::string pieces[] = {"a", "bc", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\\", "\"", " ", "\t", "\x1F"};
+    for (size_t length = 0; length < 200; length += 7)
+    {
+        std::string s;
+        while (s.size() < length)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            s += pieces[state % std::size(pieces)];
+        }
+        out.push_back(s);
+        if (!s.empty())
+        {
+            out.push_back(s + "\xC3");
+            std::string broken = s;
+            broken[broken.size() / 2] = '\xFF';
+            out.push_back(broken);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(DispatchTest, SelectsBestSupportedVariantAtLoad)
+{
+    EXPECT_TRUE(Dispatch::supported(Dispatch::BASELINE));
+    EXPECT_EQ(Dispatch::isa(), Dispatch::detect());
+    EXPECT_EQ(supportedIsas().back(), Dispatch::detect());
+    EXPECT_STREQ(Dispatch::name(Dispatch::AVX2), "avx2");
+}
+
+TEST(DispatchTest, SelectRejectsUnsupportedVariants)
+{
+    ScopedIsa scoped;
+    for (Dispatch::Isa isa : {Dispatch::SSE42, Dispatch::AVX2, Dispatch::AVX512})
+    {
+        EXPECT_EQ(Dispatch::select(isa), Dispatch::supported(isa));
+        if (Dispatch::supported(isa))
+        {
+            EXPECT_EQ(Dispatch::isa(), isa);
+        }
+    }
+}
+
+TEST(DispatchTest, VariantsAgreeWithBaseline)
+{
+    ScopedIsa scoped;
+    const std::vector<std::string> inputs = samples();
+    for (Dispatch::Isa isa : supportedIsas())
+    {
+        const Dispatch::Kernels &baseline = (Dispatch::select(Dispatch::BASELINE), Dispatch::kernels());
+        ASSERT_TRUE(Dispatch::select(isa));
+        for (const std::string &s : inputs)
+        {
+            EXPECT_EQ(Utf8::validate(s.data(), s.size()), baseline.validateUtf8(s.data(), s.size()))
+                << Dispatch::name(isa);
+            for (size_t from = 0; from < s.size() && from < 70; ++from)
+            {
+                bool ascii = true, expectedAscii = true;
+                size_t at = Utf8::findSpecial(s.data(), from, s.size(), ascii);
+                EXPECT_EQ(at, baseline.findSpecial(s.data(), from, s.size(), expectedAscii)) << Dispatch::name(isa);
+                EXPECT_EQ(ascii, expectedAscii) << Dispatch::name(isa);
+            }
+        }
+    }
+}
+
+TEST(DispatchTest, ValidatorsMatchScalarOnMalformedSequences)
+{
+    ScopedIsa scoped;
+    const std::pair<std::string, bool> sequences[] = {
+        {"\xC2\x80", true},
+        {"\xDF\xBF", true},
+        {"\xE0\xA0\x80", true},
+        {"\xED\x9F\xBF", true},
+        {"\xEE\x80\x80", true},
+        {"\xEF\xBF\xBF", true},
+        {"\xF0\x90\x80\x80", true},
+        {"\xF4\x8F\xBF\xBF", true},
+        // Overlong encodings.
+        {"\xC0\x80", false},
+        {"\xC1\xBF", false},
+        {"\xE0\x80\x80", false},
+        {"\xE0\x9F\xBF", false},
+        {"\xF0\x80\x80\x80", false},
+        {"\xF0\x8F\xBF\xBF", false},
+        // UTF-16 surrogates.
+        {"\xED\xA0\x80", false},
+        {"\xED\xBF\xBF", false},
+        // Above U+10FFFF.
+        {"\xF4\x90\x80\x80", false},
+        {"\xF5\x80\x80\x80", false},
+        {"\xF7\xBF\xBF\xBF", false},
+        {"\xF8\x88\x80\x80\x80", false},
+        // Stray continuations, invalid bytes and too many continuations.
+        {"\x80", false},
+        {"\xBF", false},
+        {"\xFE", false},
+        {"\xFF", false},
+        {"\xC3\xA9\x80", false},
+        // Truncated sequences; with no suffix they are also truncated tails.
+        {"\xC3", false},
+        {"\xE2", false},
+        {"\xE2\x82", false},
+        {"\xF0", false},
+        {"\xF0\x9F", false},
+        {"\xF0\x9F\x98", false},
+    };
+
+    for (Dispatch::Isa isa : supportedIsas())
+    {
+        ASSERT_TRUE(Dispatch::select(isa));
+        for (const auto &[sequence, valid] : sequences)
+        {
+            // Every alignment across a 64-byte block, at the very end and
+            // followed by more input.
+            for (size_t prefix = 0; prefix <= 66; ++prefix)
+            {
+                for (size_t suffix : {0, 1, 15, 33})
+                {
+                    std::string s = std::string(prefix, 'a') + sequence + std::string(suffix, 'b');
+                    bool scalar = Utf8::validateScalar(s.data(), s.size());
+                    EXPECT_EQ(scalar, valid) << prefix << '+' << suffix;
+                    EXPECT_EQ(Utf8::validate(s.data(), s.size()), scalar)
+                        << Dispatch::name(isa) << ' ' << prefix << '+' << suffix;
+                }
+            }
+        }
+    }
+}
+
+TEST(DispatchTest, ParserUsesSelectedKernels)
+{
+    ScopedIsa scoped;
+    std::string text(100, 'x');
+    std::string input = "{\"k\": \"" + text + "\\\"caf\xC3\xA9\", \"n\": 1}";
+    for (Dispatch::Isa isa : supportedIsas())
+    {
+        ASSERT_TRUE(Dispatch::select(isa));
+        Parser parser;
+        Json doc = parser.parse(input);
+        EXPECT_EQ(doc["k"].get<std::string>(), text + "\"caf\xC3\xA9") << Dispatch::name(isa);
+        EXPECT_FALSE(parser.tryParse("{\"k\": \"" + text + "\xC3\x28\"}")) << Dispatch::name(isa);
+        EXPECT_FALSE(parser.tryParse("{\"k\": \"" + text + "\t\"}")) << Dispatch::name(isa);
+    }
+}
@@ -0,0 +1,157 @@
+#include "index/ElementIndex.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+ElementIndex build(std::string_view input, ElementIndexBuilder::Format format, bool fingerprints = false,
+                   size_t chunk = 0)
+{
+    ElementIndexBuilder builder(format, fingerprints);
+    if (chunk == 0)
+        chunk = input.size() + 1;
+    for (size_t i = 0; i < input.size(); i += chunk)
+        builder.feed(input.substr(i, chunk));
+    return builder.finish();
+}
+
+std::vector<std::string> elements(std::string_view input, const ElementIndex &idx)
+{
+    std::vector<std::string> out;
+    for (size_t i = 0; i < idx.size(); ++i)
+        out.emplace_back(idx.element(input, i));
+    return out;
+}
+
+} // namespace
+
+TEST(ElementIndexTest, IndexesTopLevelArrayElements)
+{
+    std::string input = " [ {\"a\": [1, 2]}, \"x,]\\\"y\" , 3.5e2,null,\n[[]] ] \n";
+    ElementIndex idx = build(input, ElementIndexBuilder::ARRAY);
+
+    EXPECT_EQ(elements(input, idx),
+              (std::vector<std::string>{"{\"a\": [1, 2]}", "\"x,]\\\"y\"", "3.5e2", "null", "[[]]"}));
+    EXPECT_EQ(idx.sourceSize(), input.size());
+    EXPECT_FALSE(idx.hasFingerprints());
+
+    EXPECT_EQ(build("[]", ElementIndexBuilder::ARRAY).size(), 0u);
+}
+
+TEST(ElementIndexTest, IndexesNdjsonRecords)
+{
+    std::string input = "{\"id\": 1}\r\n\n  {\"id\": 2,\n \"v\": [\n1]}  \n\"text\"\n42";
+    ElementIndex idx = build(input, ElementIndexBuilder::NDJSON);
+
+    EXPECT_EQ(elements(input, idx),
+              (std::vector<std::string>{"{\"id\": 1}", "{\"id\": 2,\n \"v\": [\n1]}", "\"text\"", "42"}));
+}
+
+TEST(ElementIndexTest, ChunkBoundariesDoNotMatter)
+{
+    std::string input = "[{\"k\\\"ey\": \"va\\\\\\\"l\", \"n\": [1, {\"m\": 2}]}, \"\\u00e9\\\\\", {\"other\": true}]";
+    ElementIndex whole = build(input, ElementIndexBuilder::ARRAY, true);
+    ASSERT_EQ(whole.size(), 3u);
+
+    for (size_t chunk = 1; chunk < 9; ++chunk)
+    {
+        ElementIndex split = build(input, ElementIndexBuilder::ARRAY, true, chunk);
+        ASSERT_EQ(split.size(), whole.size()) << chunk;
+        for (size_t i = 0; i < whole.size(); ++i)
+        {
+            EXPECT_EQ(split.offset(i), whole.offset(i)) << chunk;
+            EXPECT_EQ(split.length(i), whole.length(i)) << chunk;
+        }
+        EXPECT_EQ(split.serialize(), whole.serialize()) << chunk;
+    }
+}
+
+TEST(ElementIndexTest, FingerprintsTopLevelKeys)
+{
+    std::string input = "{\"name\": \"a\", \"nested\": {\"deep\": 1}}\n"
+                        "{\"id\": 2, \"t\\u0061g\": [\"name\"]}\n"
+                        "[\"name\"]\n";
+    ElementIndex idx = build(input, ElementIndexBuilder::NDJSON, true);
+    ASSERT_EQ(idx.size(), 3u);
+    ASSERT_TRUE(idx.hasFingerprints());
+
+    EXPECT_TRUE(idx.mayContain(0, "name"));
+    EXPECT_TRUE(idx.mayContain(0, "nested"));
+    EXPECT_TRUE(idx.mayContain(1, "id"));
+    EXPECT_TRUE(idx.mayContain(1, "tag"));
+    EXPECT_FALSE(idx.mayContain(2, "name"));
+
+    // Two-bit fingerprints of a few keys may collide, but not all of these.
+    int misses = 0;
+    for (const char *key : {"deep", "missing", "value", "zzz", "other"})
+        misses += !idx.mayContain(1, key);
+    EXPECT_GT(misses, 0);
+
+    ElementIndex plain = build(input, ElementIndexBuilder::NDJSON);
+    EXPECT_TRUE(plain.mayContain(2, "anything"));
+}
+
+TEST(ElementIndexTest, SerializeRoundTrip)
+{
+    std::string input = "[1, {\"a\": 2}, [3]]";
+    for (bool fingerprints : {false, true})
+    {
+        ElementIndex idx = build(input, ElementIndexBuilder::ARRAY, fingerprints);
+        std::string bytes = idx.serialize();
+        EXPECT_EQ(bytes.size(), ElementIndex::header_size + idx.size() * (fingerprints ? 24 : 16));
+
+        ElementIndex back = ElementIndex::deserialize(bytes);
+        EXPECT_EQ(back.size(), idx.size());
+        EXPECT_EQ(back.sourceSize(), idx.sourceSize());
+        EXPECT_EQ(back.hasFingerprints(), fingerprints);
+        EXPECT_EQ(elements(input, back), elements(input, idx));
+        EXPECT_EQ(back.serialize(), bytes);
+    }
+
+    EXPECT_THROW(ElementIndex::deserialize("LJIX"), std::runtime_error);
+    EXPECT_THROW(ElementIndex::deserialize(std::string(64, 'x')), std::runtime_error);
+    std::string truncated = build(input, ElementIndexBuilder::ARRAY).serialize();
+    truncated.pop_back();
+    EXPECT_THROW(ElementIndex::deserialize(truncated), std::runtime_error);
+}
+
+TEST(ElementIndexTest, ReadsAndParsesElementsFromStream)
+{
+    std::string input = "[{\"id\": 0}, {\"id\": 1}, {\"id\": 2}, {\"id\": 3}]";
+    ElementIndex idx = build(input, ElementIndexBuilder::ARRAY);
+    std::istringstream in(input);
+
+    std::vector<std::string> slice = idx.read(in, 1, 2);
+    ASSERT_EQ(slice.size(), 2u);
+    Parser parser;
+    for (size_t i = 0; i < slice.size(); ++i)
+        EXPECT_EQ(parser.parseValue(slice[i]).get<Json>()["id"].get<int64_t>(), static_cast<int64_t>(i + 1));
+
+    EXPECT_EQ(idx.read(in, 3).front(), "{\"id\": 3}");
+    EXPECT_THROW(idx.read(in, 3, 2), std::out_of_range);
+    EXPECT_THROW(idx.read(in, 4), std::out_of_range);
+    EXPECT_THROW(idx.read(in, 0, 0), std::out_of_range);
+
+    std::istringstream shorter(input.substr(0, 20));
+    EXPECT_THROW(idx.read(shorter, 2), std::runtime_error);
+}
+
+TEST(ElementIndexTest, RejectsMalformedStructure)
+{
+    EXPECT_THROW(build("{\"a\": 1}", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("[1, 2", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("[1] [2]", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("[, 1]", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("[{} {}]", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("[\"open]", ElementIndexBuilder::ARRAY), std::runtime_error);
+    EXPECT_THROW(build("{\"a\": 1} {\"b\": 2}\n", ElementIndexBuilder::NDJSON), std::runtime_error);
+    EXPECT_THROW(build("{\"a\": [1}\n", ElementIndexBuilder::NDJSON), std::runtime_error);
+    EXPECT_THROW(build("{\"a\": 1\n", ElementIndexBuilder::NDJSON), std::runtime_error);
+}
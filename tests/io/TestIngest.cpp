@@ -0,0 +1,161 @@
+#include "io/Ingest.h"
+
+#ifdef LIBJSON_INGEST
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+class IngestTest : public ::testing::Test
+{
+protected:
+    std::filesystem::path dir;
+    std::vector<std::string> paths;
+
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() /
+              ("libjson_ingest_" + std::to_string(::getpid()) + "_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    void add(const std::string &content)
+    {
+        std::string path = (dir / (std::to_string(paths.size()) + ".json")).string();
+        std::ofstream(path, std::ios::binary) << content;
+        paths.push_back(path);
+    }
+
+    // Documents of widely varying size so buffers are reused and regrown.
+    void addDocuments(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            add("{\"id\": " + std::to_string(i) + ", \"pad\": \"" + std::string((i * 7919) % 300000, 'x') + "\"}");
+    }
+
+    static std::vector<IngestPipeline::Backend> backends()
+    {
+        std::vector<IngestPipeline::Backend> out{IngestPipeline::PREAD};
+        if (IngestPipeline(1, 4).backend() == IngestPipeline::IO_URING)
+            out.push_back(IngestPipeline::IO_URING);
+        return out;
+    }
+};
+
+} // namespace
+
+TEST_F(IngestTest, ParsesEveryFileOnEachBackend)
+{
+    addDocuments(150);
+    for (IngestPipeline::Backend backend : backends())
+    {
+        IngestPipeline pipeline(3, 8, backend);
+        EXPECT_EQ(pipeline.backend(), backend);
+
+        std::vector<int> seen(paths.size(), 0);
+        std::mutex mutex;
+        pipeline.run(paths, [&](size_t index, IngestPipeline::result_t result)
+                     {
+                         ASSERT_TRUE(result) << result.error();
+                         std::lock_guard lock(mutex);
+                         ++seen[index];
+                         EXPECT_EQ((*result)["id"].get<int64_t>(), static_cast<int64_t>(index));
+                         EXPECT_EQ((*result)["pad"].get<std::string>().size(), (index * 7919) % 300000);
+                     });
+        EXPECT_EQ(seen, std::vector<int>(paths.size(), 1));
+    }
+}
+
+TEST_F(IngestTest, ReportsUnreadableAndInvalidFiles)
+{
+    add("{\"ok\": true}");
+    add("");
+    add("{\"broken\": ");
+    paths.push_back((dir / "missing.json").string());
+    add("[1, 2]");
+
+    for (IngestPipeline::Backend backend : backends())
+    {
+        IngestPipeline pipeline(2, 2, backend);
+        std::vector<std::string> errors(paths.size());
+        std::vector<bool> ok(paths.size(), false);
+        std::mutex mutex;
+        pipeline.run(paths, [&](size_t index, IngestPipeline::result_t result)
+                     {
+                         std::lock_guard lock(mutex);
+                         if (result)
+                             ok[index] = true;
+                         else
+                             errors[index] = result.error();
+                     });
+
+        EXPECT_TRUE(ok[0]);
+        for (size_t i = 1; i < paths.size(); ++i)
+        {
+            EXPECT_FALSE(ok[i]) << i;
+            EXPECT_EQ(errors[i].rfind(paths[i] + ": ", 0), 0u) << errors[i];
+        }
+        EXPECT_NE(errors[3].find("No such file"), std::string::npos) << errors[3];
+    }
+}
+
+TEST_F(IngestTest, CompletesWhenParsingFallsBehind)
+{
+    addDocuments(40);
+    for (IngestPipeline::Backend backend : backends())
+    {
+        // One slow parser and two reads in flight: three buffers in all, so
+        // reading keeps stalling until a buffer is handed back.
+        IngestPipeline pipeline(1, 2, backend);
+        std::atomic<size_t> delivered{0};
+        pipeline.run(paths, [&](size_t, IngestPipeline::result_t result)
+                     {
+                         ASSERT_TRUE(result);
+                         std::this_thread::sleep_for(std::chrono::microseconds(200));
+                         ++delivered;
+                     });
+        EXPECT_EQ(delivered.load(), paths.size());
+    }
+}
+
+TEST_F(IngestTest, CallbackExceptionStopsTheRun)
+{
+    addDocuments(60);
+    for (IngestPipeline::Backend backend : backends())
+    {
+        IngestPipeline pipeline(2, 4, backend);
+        std::atomic<size_t> calls{0};
+        EXPECT_THROW(pipeline.run(paths, [&](size_t, IngestPipeline::result_t)
+                                  {
+                                      if (++calls == 5)
+                                          throw std::runtime_error("stop");
+                                  }),
+                     std::runtime_error);
+        EXPECT_LT(calls.load(), paths.size());
+
+        // The pipeline is reusable after a failed run.
+        std::atomic<size_t> again{0};
+        pipeline.run(paths, [&](size_t, IngestPipeline::result_t result)
+                     {
+                         if (result)
+                             ++again;
+                     });
+        EXPECT_EQ(again.load(), paths.size());
+    }
+}
+
+#endif // LIBJSON_INGEST
@@ -0,0 +1,67 @@
+#include "io/Sink.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+TEST(SinkTest, StringSinkAppends)
+{
+    std::string out = "x";
+    StringSink sink(out);
+    sink.write("abc", 3);
+    sink.write("de", 2);
+    EXPECT_EQ(out, "xabcde");
+}
+
+TEST(SinkTest, OstreamSinkWrites)
+{
+    std::ostringstream os;
+    OstreamSink sink(os);
+    sink.write("hello", 5);
+    EXPECT_EQ(os.str(), "hello");
+}
+
+TEST(SinkTest, CallbackSinkForwards)
+{
+    std::string seen;
+    CallbackSink sink([&](const char *data, size_t size)
+                      { seen.append(data, size); });
+    sink.write("cb", 2);
+    EXPECT_EQ(seen, "cb");
+}
+
+#ifdef LIBJSON_SINK_FD
+
+TEST(SinkTest, FdSinkWritesAllBytes)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    FdSink sink(fds[1]);
+    sink.write("pipe data", 9);
+    ::close(fds[1]);
+
+    char buf[16] = {};
+    ssize_t n = ::read(fds[0], buf, sizeof(buf));
+    ::close(fds[0]);
+    EXPECT_EQ(std::string(buf, static_cast<size_t>(n)), "pipe data");
+}
+
+TEST(SinkTest, FdSinkGatherWrite)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    std::string_view parts[] = {"gather", "", " ", "write"};
+    FdSink sink(fds[1]);
+    sink.writev(parts, 4);
+    ::close(fds[1]);
+
+    char buf[32] = {};
+    ssize_t n = ::read(fds[0], buf, sizeof(buf));
+    ::close(fds[0]);
+    EXPECT_EQ(std::string(buf, static_cast<size_t>(n)), "gather write");
+}
+
+#endif
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 // ----------------------------
 // JsonValue type tests
 // ----------------------------
@@ -254,3 +256,131 @@ TEST(JsonComplexTest, StreamOutputOfComplexJson)
 	EXPECT_NE(output.find("\"flag\""), std::string::npos);
 	EXPECT_NE(output.find("true"), std::string::npos);
 }
+
+// ----------------------------
+// Move semantics
+// ----------------------------
+
+TEST(JsonValueTest, RvalueConversionMoves)
+{
+	JsonValue j(JsonValue::array_t{1, 2, 3});
+	const JsonValue *first = &j.get<JsonValue::array_t>()[0];
+
+	auto arr = static_cast<JsonValue::array_t>(std::move(j));
+	ASSERT_EQ(arr.size(), 3);
+	EXPECT_EQ(&arr[0], first);
+}
+
+TEST(JsonValueTest, GetReturnsReferences)
+{
+	JsonValue j(JsonValue::array_t{1, 2});
+	j.get<JsonValue::array_t>().push_back(3);
+
+	const JsonValue &cj = j;
+	EXPECT_EQ(cj.get<JsonValue::array_t>().size(), 3);
+	EXPECT_THROW(cj.get<JsonValue::string_t>(), std::bad_variant_access);
+}
+
+TEST(JsonValueTest, RvalueGetExtractsValue)
+{
+	std::string s(64, 'y');
+	JsonValue j(std::move(s));
+	const char *buffer = j.get<JsonValue::string_t>().data();
+
+	std::string out = std::move(j).get<JsonValue::string_t>();
+	EXPECT_EQ(out.data(), buffer);
+}
+
+// ----------------------------
+// Copy-on-write sharing
+// ----------------------------
+
+TEST(JsonSharedTest, CopyOfSharedValueSharesStorage)
+{
+	JsonValue a(JsonValue::array_t{1, JsonValue::object_t{{"k", "v"}}, 3});
+	a.share();
+	EXPECT_TRUE(a.is_shared());
+	EXPECT_TRUE(a.is_array());
+
+	JsonValue b = a;
+	const JsonValue &ca = a;
+	const JsonValue &cb = b;
+	EXPECT_EQ(&ca.get<JsonValue::array_t>(), &cb.get<JsonValue::array_t>());
+	EXPECT_TRUE(ca.get<JsonValue::array_t>()[1].is_shared());
+}
+
+TEST(JsonSharedTest, MutationDetachesOnlyTouchedLevel)
+{
+	JsonValue a(JsonValue::array_t{1, JsonValue::object_t{{"k", "v"}}});
+	a.share();
+	JsonValue b = a;
+
+	b.get<JsonValue::array_t>().push_back(2);
+	EXPECT_FALSE(b.is_shared());
+	EXPECT_EQ(a.get<JsonValue::array_t>().size(), 2);
+	EXPECT_EQ(b.get<JsonValue::array_t>().size(), 3);
+
+	const JsonValue &ca = a;
+	const JsonValue &cb = b;
+	EXPECT_EQ(&ca.get<JsonValue::array_t>()[1].get<JsonValue::object_t>(),
+			  &cb.get<JsonValue::array_t>()[1].get<JsonValue::object_t>());
+}
+
+TEST(JsonSharedTest, DetachAlwaysCopies)
+{
+	JsonValue a(JsonValue::array_t{1, 2, 3});
+	a.share();
+	JsonValue b = a;
+	const JsonValue::array_t *shared = &static_cast<const JsonValue &>(b).get<JsonValue::array_t>();
+
+	auto &arr = a.get<JsonValue::array_t>();
+	arr[0] = 7;
+	EXPECT_FALSE(a.is_shared());
+	EXPECT_NE(&arr, shared);
+	EXPECT_EQ(static_cast<const JsonValue &>(b).get<JsonValue::array_t>()[0].get<JsonValue::number_integer_t>(), 1);
+	EXPECT_EQ(arr[0].get<JsonValue::number_integer_t>(), 7);
+}
+
+TEST(JsonSharedTest, ConversionsAndStreamingSeeSharedContent)
+{
+	JsonValue::object_t obj;
+	obj["a"] = JsonValue::array_t{1, 2};
+	JsonValue v(std::move(obj));
+	v.share();
+
+	auto copy = static_cast<JsonValue::object_t>(v);
+	EXPECT_EQ(static_cast<JsonValue::array_t>(copy["a"]).size(), 2);
+
+	std::ostringstream os;
+	os << v;
+	EXPECT_EQ(os.str(), "{\"a\": [1, 2]}");
+}
+
+TEST(JsonSharedTest, ConcurrentReadersOfSharedDocument)
+{
+	JsonValue::array_t items;
+	for (int i = 0; i < 1000; ++i)
+		items.push_back(JsonValue::object_t{{"id", i}});
+	JsonValue doc(std::move(items));
+	doc.share();
+
+	std::vector<std::thread> readers;
+	std::vector<int64_t> sums(4, 0);
+	for (size_t t = 0; t < sums.size(); ++t)
+	{
+		readers.emplace_back([&, t]()
+							 {
+			JsonValue local = doc;
+			const JsonValue &c = local;
+			for (const auto &item : c.get<JsonValue::array_t>())
+			{
+				const auto &o = item.get<JsonValue::object_t>();
+				sums[t] += o.begin()->second.get<JsonValue::number_integer_t>();
+			} });
+	}
+	for (auto &r : readers)
+		r.join();
+
+	for (int64_t s : sums)
+		EXPECT_EQ(s, 999 * 1000 / 2);
+}
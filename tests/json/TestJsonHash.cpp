@@ -0,0 +1,108 @@
+#include "json/JsonHash.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+static Json parse(std::string_view text, Parser::NumberMode mode = Parser::BINARY)
+{
+	Parser parser;
+	parser.setNumberMode(mode);
+	return parser.parse(text);
+}
+
+TEST(JsonEqualityTest, KeyOrderDoesNotMatter)
+{
+	Json a = parse(R"({"a": 1, "b": [true, null, "x"], "c": {"d": 2.5}})");
+	Json b = parse(R"({"c": {"d": 2.5}, "b": [true, null, "x"], "a": 1})");
+	EXPECT_TRUE(a == b);
+	EXPECT_EQ(JsonHash{}(a), JsonHash{}(b));
+	EXPECT_EQ(std::hash<Json>{}(a), std::hash<Json>{}(b));
+}
+
+TEST(JsonEqualityTest, StopsAtDifferences)
+{
+	Json a = parse(R"({"a": [1, 2, 3], "b": "x"})");
+	EXPECT_FALSE(a == parse(R"({"a": [1, 2, 4], "b": "x"})"));
+	EXPECT_FALSE(a == parse(R"({"a": [1, 2], "b": "x"})"));
+	EXPECT_FALSE(a == parse(R"({"a": [1, 2, 3], "c": "x"})"));
+	EXPECT_FALSE(a == parse(R"({"a": [1, 2, 3]})"));
+	EXPECT_FALSE(a == parse(R"({"a": {"0": 1}, "b": "x"})"));
+	EXPECT_NE(JsonHash{}(a), JsonHash{}(parse(R"({"a": [1, 3, 2], "b": "x"})")));
+}
+
+TEST(JsonEqualityTest, ScalarTypes)
+{
+	EXPECT_TRUE(JsonValue(nullptr) == JsonValue(nullptr));
+	EXPECT_FALSE(JsonValue(nullptr) == JsonValue(false));
+	EXPECT_FALSE(JsonValue("1") == JsonValue(1));
+	EXPECT_FALSE(JsonValue(true) == JsonValue(1));
+	EXPECT_TRUE(JsonValue("s") == JsonValue(std::string("s")));
+}
+
+TEST(JsonEqualityTest, NumbersCompareByValue)
+{
+	EXPECT_TRUE(JsonValue(1) == JsonValue(1.0));
+	EXPECT_TRUE(JsonValue(JsonNumber("1e2")) == JsonValue(100));
+	EXPECT_TRUE(JsonValue(JsonNumber("0.5")) == JsonValue(0.5));
+	EXPECT_FALSE(JsonValue(1) == JsonValue(1.5));
+	EXPECT_EQ(JsonHash{}(JsonValue(JsonNumber("2.0"))), JsonHash{}(JsonValue(2)));
+
+	Json raw = parse(R"({"id": 123456789012345678901234567890, "n": 3})", Parser::RAW);
+	Json same = parse(R"({"n": 3.0, "id": 123456789012345678901234567890})", Parser::RAW);
+	EXPECT_TRUE(raw == same);
+	EXPECT_TRUE(raw == parse(R"({"n": 3, "id": 123456789012345678901234567890})", Parser::RAW));
+	EXPECT_EQ(JsonHash{}(raw), JsonHash{}(same));
+}
+
+TEST(JsonEqualityTest, SharedAndOwnedCompareEqual)
+{
+	JsonValue owned = parse(R"({"a": [1, {"b": 2}]})");
+	JsonValue shared = owned;
+	shared.share();
+	EXPECT_TRUE(owned == shared);
+	EXPECT_EQ(JsonHash{}(owned), JsonHash{}(shared));
+
+	JsonValue copy = shared;
+	EXPECT_TRUE(copy == shared);
+}
+
+TEST(JsonHashTest, IncrementalObjectHash)
+{
+	Json obj = parse(R"({"a": 1, "b": "two"})");
+	JsonHash hash;
+
+	uint64_t sum = 0;
+	for (const auto &kv : obj)
+		sum += JsonHash::entry(kv.first, hash(kv.second));
+	EXPECT_EQ(JsonHash::object(sum), hash(obj));
+
+	JsonValue c = JsonValue::array_t{true};
+	sum += JsonHash::entry("c", hash(c));
+	obj["c"] = c;
+	EXPECT_EQ(JsonHash::object(sum), hash(obj));
+}
+
+TEST(JsonHashTest, CacheRemembersSharedContainers)
+{
+	JsonValue doc = parse(R"({"a": [1, 2, 3], "b": {"c": null}})");
+	uint64_t plain = JsonHash{}(doc);
+	doc.share();
+
+	JsonHashCache cache;
+	JsonHash hash(cache);
+	EXPECT_EQ(hash(doc), plain);
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(hash(doc), plain);
+	EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(JsonHashTest, WorksInUnorderedSet)
+{
+	std::unordered_set<JsonValue> seen;
+	seen.insert(JsonValue(parse(R"({"x": 1, "y": 2})")));
+	seen.insert(JsonValue(parse(R"({"y": 2, "x": 1})")));
+	seen.insert(JsonValue(parse(R"({"y": 2, "x": 1.5})")));
+	EXPECT_EQ(seen.size(), 2);
+}
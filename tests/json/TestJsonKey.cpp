@@ -0,0 +1,66 @@
+#include "json/Json.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string_view>
+
+static_assert(JsonKey("id").hash() == JsonKey::hash("id"));
+
+TEST(JsonKeyTest, HashMatchesForEveryKeyForm)
+{
+	std::string s = "a somewhat longer key name";
+	std::string_view v = s;
+	JsonKeyHash h;
+	EXPECT_EQ(h(s), h(v));
+	EXPECT_EQ(h(s), h(s.c_str()));
+	EXPECT_EQ(h(s), h(JsonKey(v)));
+	EXPECT_NE(JsonKey::hash("ab"), JsonKey::hash("ba"));
+	EXPECT_NE(JsonKey::hash(""), JsonKey::hash(std::string_view("\0", 1)));
+}
+
+TEST(JsonKeyTest, FindDoesNotInsert)
+{
+	Parser parser;
+	Json j = parser.parse(R"({"id": 7, "name": "x"})");
+
+	auto it = j.find("id");
+	ASSERT_TRUE(it != j.end());
+	EXPECT_EQ(it->second.get<JsonValue::number_integer_t>(), 7);
+	EXPECT_TRUE(j.find(std::string_view("missing")) == j.end());
+	EXPECT_EQ(j.size(), 2u);
+}
+
+TEST(JsonKeyTest, PrecomputedKeysAcrossDocuments)
+{
+	static constexpr JsonKey id{"id"};
+	Parser parser;
+	int64_t sum = 0;
+	for (int i = 0; i < 5; ++i)
+	{
+		Json j = parser.parse("{\"id\": " + std::to_string(i) + "}");
+		ASSERT_TRUE(j.contains(id));
+		sum += j.at(id).get<JsonValue::number_integer_t>();
+	}
+	EXPECT_EQ(sum, 10);
+}
+
+TEST(JsonKeyTest, AtThrowsOnMissingKey)
+{
+	const Json j{{"a", 1}};
+	EXPECT_EQ(j.at("a").get<JsonValue::number_integer_t>(), 1);
+	EXPECT_THROW(j.at(std::string("b")), std::out_of_range);
+	EXPECT_FALSE(j.contains("b"));
+}
+
+TEST(JsonKeyTest, SubscriptInsertsOnlyOnMiss)
+{
+	Json j;
+	j["a"] = 1;
+	j[JsonKey("a")] = 2;
+	j[std::string_view("b")] = 3;
+	EXPECT_EQ(j.size(), 2u);
+	EXPECT_EQ(j["a"].get<JsonValue::number_integer_t>(), 2);
+	EXPECT_EQ(j["b"].get<JsonValue::number_integer_t>(), 3);
+}
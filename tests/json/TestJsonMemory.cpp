@@ -0,0 +1,85 @@
+#include "json/Json.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+TEST(JsonMemoryTest, EmptyObjectHoldsOnlyBuckets)
+{
+	Json j;
+	MemoryUsage usage = j.memory_usage();
+	EXPECT_EQ(usage.keys, 0u);
+	EXPECT_EQ(usage.strings, 0u);
+	EXPECT_EQ(usage.containers, 0u);
+	EXPECT_EQ(usage.total(), usage.overhead);
+}
+
+TEST(JsonMemoryTest, ShortStringsStayInline)
+{
+	Json j;
+	j["a"] = "short";
+	MemoryUsage usage = j.memory_usage();
+	EXPECT_EQ(usage.keys, 0u);
+	EXPECT_EQ(usage.strings, 0u);
+	EXPECT_GT(usage.containers, 0u);
+}
+
+TEST(JsonMemoryTest, CountsKeysAndStrings)
+{
+	std::string key(40, 'k');
+	std::string text(100, 'x');
+	Json j;
+	j[key] = text;
+	MemoryUsage usage = j.memory_usage();
+	EXPECT_GE(usage.keys, key.size() + 1);
+	EXPECT_GE(usage.strings, text.size() + 1);
+	EXPECT_EQ(usage.total(), usage.keys + usage.strings + usage.containers + usage.slack + usage.overhead);
+}
+
+TEST(JsonMemoryTest, ArraySlackIsReportedAndTrimmed)
+{
+	JsonValue::array_t arr;
+	arr.reserve(64);
+	for (int i = 0; i < 8; ++i)
+		arr.push_back(i);
+	JsonValue v(std::move(arr));
+
+	MemoryUsage before = v.memory_usage();
+	EXPECT_EQ(before.containers, 8 * sizeof(JsonValue));
+	EXPECT_EQ(before.slack, 56 * sizeof(JsonValue));
+
+	v.shrink_to_fit();
+	MemoryUsage after = v.memory_usage();
+	EXPECT_EQ(after.containers, before.containers);
+	EXPECT_EQ(after.slack, 0u);
+}
+
+TEST(JsonMemoryTest, ShrinkKeepsContentsAndReducesTotal)
+{
+	std::string text = "{\"items\": [";
+	for (int i = 0; i < 200; ++i)
+		text += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"a fairly long name string\"}";
+	text += "]}";
+
+	Parser parser;
+	Json j = parser.parse(text);
+	Json copy = j;
+	MemoryUsage before = j.memory_usage();
+
+	j.shrink_to_fit();
+	MemoryUsage after = j.memory_usage();
+	EXPECT_TRUE(j == copy);
+	EXPECT_LE(after.total(), before.total());
+	EXPECT_EQ(after.slack, 0u);
+	EXPECT_EQ(after.strings, before.strings);
+}
+
+TEST(JsonMemoryTest, SharedContainersCountedOnce)
+{
+	JsonValue inner = JsonValue::array_t{1, 2, 3};
+	inner.share();
+
+	JsonValue one = JsonValue::array_t{inner};
+	JsonValue two = JsonValue::array_t{inner, inner};
+	size_t element = sizeof(JsonValue);
+	EXPECT_EQ(two.memory_usage().total() - one.memory_usage().total(), element);
+}
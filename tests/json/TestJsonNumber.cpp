@@ -0,0 +1,71 @@
+#include "json/Json.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+TEST(JsonNumberTest, KeepsOriginalText)
+{
+	JsonNumber n("1.50e+10");
+	EXPECT_EQ(n.raw(), "1.50e+10");
+	EXPECT_FALSE(n.is_integer());
+	EXPECT_DOUBLE_EQ(n.get<double>(), 1.5e10);
+}
+
+TEST(JsonNumberTest, IntegerConversion)
+{
+	EXPECT_EQ(JsonNumber("-42").get<int64_t>(), -42);
+	EXPECT_EQ(JsonNumber("-9223372036854775808").get<int64_t>(), INT64_MIN);
+	EXPECT_EQ(JsonNumber("18446744073709551615").get<uint64_t>(), UINT64_MAX);
+	EXPECT_THROW(JsonNumber("9223372036854775808").get<int64_t>(), std::out_of_range);
+	EXPECT_THROW(JsonNumber("-1").get<uint64_t>(), std::out_of_range);
+	EXPECT_THROW(JsonNumber("1.0").get<int64_t>(), std::invalid_argument);
+}
+
+#ifdef LIBJSON_INT128
+TEST(JsonNumberTest, Int128)
+{
+	JsonNumber n("170141183460469231731687303715884105727");
+	unsigned __int128 expected = (static_cast<unsigned __int128>(1) << 127) - 1;
+	EXPECT_TRUE(n.get<__int128>() == static_cast<__int128>(expected));
+	EXPECT_THROW(JsonNumber("340282366920938463463374607431768211456").get<unsigned __int128>(), std::out_of_range);
+}
+#endif
+
+TEST(JsonNumberTest, RejectsInvalidText)
+{
+	EXPECT_THROW(JsonNumber(""), std::invalid_argument);
+	EXPECT_THROW(JsonNumber("01"), std::invalid_argument);
+	EXPECT_THROW(JsonNumber("1."), std::invalid_argument);
+	EXPECT_THROW(JsonNumber("-"), std::invalid_argument);
+	EXPECT_THROW(JsonNumber("1e"), std::invalid_argument);
+	EXPECT_THROW(JsonNumber("+1"), std::invalid_argument);
+	EXPECT_NO_THROW(JsonNumber("-0.0E-5"));
+}
+
+TEST(JsonNumberTest, JsonValueAccessAndOutput)
+{
+	JsonValue v(JsonNumber("3.14159265358979323846"));
+	EXPECT_TRUE(v.is_raw_number());
+	EXPECT_FALSE(v.is_float());
+	EXPECT_DOUBLE_EQ(static_cast<double>(v), 3.14159265358979323846);
+
+	std::ostringstream os;
+	os << v;
+	EXPECT_EQ(os.str(), "3.14159265358979323846");
+
+	JsonValue i(JsonNumber("12"));
+	EXPECT_EQ(static_cast<int64_t>(i), 12);
+}
+
+TEST(JsonNumberTest, TryGetDoesNotThrow)
+{
+	int64_t i = 0;
+	EXPECT_TRUE(JsonNumber("123").try_get(i));
+	EXPECT_EQ(i, 123);
+	EXPECT_FALSE(JsonNumber("1e3").try_get(i));
+	EXPECT_FALSE(JsonNumber("99999999999999999999").try_get(i));
+
+	JsonNumber unchecked("2.5", JsonNumber::unchecked);
+	EXPECT_FALSE(unchecked.is_integer());
+}
@@ -0,0 +1,146 @@
+#include "json/JsonHash.h"
+#include "parser/Parser.h"
+#include "writer/ParallelSerializer.h"
+#include "writer/Writer.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+static Json parsePacked(std::string_view text)
+{
+	Parser parser;
+	parser.setPackArrays(true);
+	return parser.parse(text);
+}
+
+static std::string print(const Json &j)
+{
+	std::ostringstream os;
+	os << j;
+	return os.str();
+}
+
+TEST(PackedArrayTest, IntegersPackAsInt64)
+{
+	Json j = parsePacked(R"({"a": [1, -2, 3000000000]})");
+	ASSERT_TRUE(j["a"].is_array());
+	ASSERT_TRUE(j["a"].is_packed<JsonValue::number_integer_t>());
+	auto values = j["a"].packed<JsonValue::number_integer_t>();
+	ASSERT_EQ(values.size(), 3u);
+	EXPECT_EQ(values[0], 1);
+	EXPECT_EQ(values[1], -2);
+	EXPECT_EQ(values[2], 3000000000);
+}
+
+TEST(PackedArrayTest, FloatsPackAsDouble)
+{
+	Json j = parsePacked(R"({"point": [12.0, 45.5]})");
+	ASSERT_TRUE(j["point"].is_packed<JsonValue::number_float_t>());
+	auto values = j["point"].packed<JsonValue::number_float_t>();
+	EXPECT_DOUBLE_EQ(values[0], 12.0);
+	EXPECT_DOUBLE_EQ(values[1], 45.5);
+}
+
+TEST(PackedArrayTest, MixedNumbersKeepTheirTypes)
+{
+	Json j = parsePacked(R"({"point": [12, 45.5], "rev": [0.5, 1]})");
+	EXPECT_FALSE(j["point"].is_packed());
+	EXPECT_FALSE(j["rev"].is_packed());
+	const auto &point = j["point"].get<JsonValue::array_t>();
+	EXPECT_TRUE(point[0].is_integer());
+	EXPECT_EQ(point[0].get<JsonValue::number_integer_t>(), 12);
+	EXPECT_FALSE(JsonValue(JsonValue::array_t{1, 2.5}).pack());
+}
+
+TEST(PackedArrayTest, OnlyHomogeneousNumericArraysPack)
+{
+	Json j = parsePacked(R"({"s": [1, "x"], "e": [], "n": [[1], [2]], "big": [9007199254740993, 0.5]})");
+	EXPECT_FALSE(j["s"].is_packed());
+	EXPECT_FALSE(j["e"].is_packed());
+	EXPECT_FALSE(j["n"].is_packed());
+	EXPECT_TRUE(j["n"].get<JsonValue::array_t>()[0].is_packed());
+	EXPECT_FALSE(j["big"].is_packed());
+}
+
+TEST(PackedArrayTest, DisabledByDefault)
+{
+	Parser parser;
+	Json j = parser.parse(R"({"a": [1, 2, 3]})");
+	EXPECT_FALSE(j["a"].is_packed());
+}
+
+TEST(PackedArrayTest, SerializesLikeGenericArray)
+{
+	std::string text = R"({"a": [1, 2, 3], "b": [0.5, 2, -1.25]})";
+	Parser parser;
+	Json generic = parser.parse(text);
+	Json packed = parsePacked(text);
+
+	EXPECT_EQ(print(packed), print(generic));
+
+	std::string a, b;
+	Writer<StringSink> wa{StringSink(a)};
+	wa.value(packed);
+	wa.finish();
+	Writer<StringSink> wb{StringSink(b)};
+	wb.value(generic);
+	wb.finish();
+	EXPECT_EQ(a, b);
+}
+
+TEST(PackedArrayTest, EqualityAndHashMatchGenericArray)
+{
+	std::string text = R"({"a": [1, 2, 3], "b": [0.5, 2, -1.25]})";
+	Parser parser;
+	Json generic = parser.parse(text);
+	Json packed = parsePacked(text);
+
+	EXPECT_TRUE(packed == generic);
+	EXPECT_EQ(JsonHash{}(packed), JsonHash{}(generic));
+
+	Json other = parsePacked(R"({"a": [1, 2, 4], "b": [0.5, 2, -1.25]})");
+	EXPECT_FALSE(other == generic);
+}
+
+TEST(PackedArrayTest, MutableAccessUnpacks)
+{
+	Json j = parsePacked(R"({"a": [1, 2]})");
+	auto &arr = j["a"].get<JsonValue::array_t>();
+	EXPECT_FALSE(j["a"].is_packed());
+	arr.push_back("three");
+	EXPECT_EQ(print(j), R"({"a": [1, 2, "three"]})");
+}
+
+TEST(PackedArrayTest, SpanWritesInPlace)
+{
+	JsonValue v = JsonValue::packed_float_t{1.0, 2.0};
+	for (double &d : v.packed<JsonValue::number_float_t>())
+		d *= 2;
+	EXPECT_TRUE(v == (JsonValue{2.0, 4.0}));
+}
+
+TEST(PackedArrayTest, PackAndUnpackRoundTrip)
+{
+	JsonValue v{1, 2, 3};
+	JsonValue original = v;
+	EXPECT_TRUE(v.pack());
+	EXPECT_TRUE(v.is_packed());
+	EXPECT_LT(v.memory_usage().total(), original.memory_usage().total());
+	v.unpack();
+	EXPECT_FALSE(v.is_packed());
+	EXPECT_TRUE(v == original);
+}
+
+TEST(PackedArrayTest, ParallelSerializerSplitsPackedArrays)
+{
+	JsonValue::packed_integer_t values;
+	for (int64_t i = 0; i < 1000; ++i)
+		values.push_back(i * 7);
+	Json j;
+	j["values"] = std::move(values);
+
+	ParallelSerializer serializer(4, 64);
+	EXPECT_GT(serializer.serialize(j).size(), 10u);
+	EXPECT_EQ(serializer.dump(j), print(j));
+}
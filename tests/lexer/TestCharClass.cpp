@@ -0,0 +1,71 @@
+#include "lexer/CharClass.h"
+#include "lexer/Lexer.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+static size_t referenceSkip(const std::string &s, size_t i, bool digits)
+{
+    auto match = [digits](char c)
+    {
+        return digits ? (c >= '0' && c <= '9') : (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    };
+    while (i < s.size() && match(s[i]))
+        ++i;
+    return i;
+}
+
+TEST(CharClassTest, SwarRunsMatchReference)
+{
+    const std::string alphabet = " \t\n\r0123456789/:\x80\xFF" "a,";
+    std::mt19937 rng(42);
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::string s(rng() % 40, ' ');
+        for (auto &c : s)
+            c = alphabet[rng() % (rng() % 2 ? 4 : alphabet.size())];
+        for (size_t i = 0; i <= s.size(); ++i)
+        {
+            ASSERT_EQ(CharClass::skipWhitespace(s.data(), i, s.size()), referenceSkip(s, i, false)) << s;
+            ASSERT_EQ(CharClass::skipDigits(s.data(), i, s.size()), referenceSkip(s, i, true)) << s;
+        }
+    }
+}
+
+TEST(CharClassTest, ClassesIgnoreLocaleAndHighBytes)
+{
+    EXPECT_TRUE(CharClass::is('7', CharClass::DIGIT));
+    EXPECT_TRUE(CharClass::is('e', CharClass::NUMBER));
+    EXPECT_TRUE(CharClass::is('Z', CharClass::ALPHA));
+    EXPECT_FALSE(CharClass::is('\xE9', CharClass::ALPHA));
+    EXPECT_FALSE(CharClass::is('\v', CharClass::WHITESPACE));
+}
+
+TEST(CharClassTest, LiteralsUseWholeWords)
+{
+    EXPECT_EQ(Lexer("true").nextToken().type, Token::TRUE);
+    EXPECT_EQ(Lexer("false]").nextToken().type, Token::FALSE);
+    EXPECT_EQ(Lexer("null,").nextToken().type, Token::NULLTOKEN);
+    EXPECT_EQ(Lexer("truex").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("fals").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("nul").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("nan").nextToken().type, Token::INVALID);
+}
+
+TEST(CharClassTest, LongNumbersAndWhitespaceRuns)
+{
+    Lexer lexer("                 -12345678901234567.0000000000001e+00012      \n\t  7");
+    Token t = lexer.nextToken();
+    EXPECT_EQ(t.type, Token::FLOAT);
+    EXPECT_EQ(t.lexeme, "-12345678901234567.0000000000001e+00012");
+    EXPECT_EQ(t.pos, 17u);
+    t = lexer.nextToken();
+    EXPECT_EQ(t.type, Token::INTEGER);
+    EXPECT_EQ(t.lexeme, "7");
+
+    EXPECT_EQ(Lexer("1.").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("1e+").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("-").nextToken().type, Token::INVALID);
+}
@@ -169,3 +169,80 @@ TEST(LexerTest, InvalidCharacter)
     EXPECT_EQ(t.type, Token::INVALID);
     EXPECT_EQ(t.lexeme, "@");
 }
+
+TEST(LexerTest, TokeniseIntoExistingVector)
+{
+    std::vector<Token> tokens;
+    Lexer lexer("[1, 2, 3, 4]");
+    lexer.tokenise(tokens);
+    ASSERT_EQ(tokens.size(), 10);
+    const Token *storage = tokens.data();
+
+    lexer.reset("{\"k\": null}");
+    lexer.tokenise(tokens);
+    ASSERT_EQ(tokens.size(), 6);
+    EXPECT_EQ(tokens.data(), storage);
+    EXPECT_EQ(tokens[1].type, Token::STRING);
+    EXPECT_EQ(tokens[1].lexeme, "k");
+    EXPECT_EQ(tokens[3].type, Token::NULLTOKEN);
+    EXPECT_EQ(tokens[5].type, Token::EOFTOKEN);
+}
+
+// --- UNICODE TESTS ---
+
+TEST(LexerTest, UnicodeEscape)
+{
+    Lexer lexer("\"caf\\u00e9 \\u20AC\"");
+    Token t = lexer.nextToken();
+    EXPECT_EQ(t.type, Token::STRING);
+    EXPECT_EQ(t.lexeme, "caf\xC3\xA9 \xE2\x82\xAC");
+}
+
+TEST(LexerTest, SurrogatePairEscape)
+{
+    Lexer lexer("\"\\ud83d\\ude00\"");
+    Token t = lexer.nextToken();
+    EXPECT_EQ(t.type, Token::STRING);
+    EXPECT_EQ(t.lexeme, "\xF0\x9F\x98\x80");
+}
+
+TEST(LexerTest, LoneSurrogateIsInvalid)
+{
+    EXPECT_EQ(Lexer("\"\\ud83d\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\\ude00\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\\ud83d\\u0041\"").nextToken().type, Token::INVALID);
+}
+
+TEST(LexerTest, InvalidEscapes)
+{
+    EXPECT_EQ(Lexer("\"\\x41\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\\u12G4\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\\u12\"").nextToken().type, Token::INVALID);
+}
+
+TEST(LexerTest, RawUtf8PassesThrough)
+{
+    std::string text = "\xF0\x9F\x98\x80 caf\xC3\xA9 plus a long ASCII tail that spans several vector blocks";
+    Lexer lexer("\"" + text + "\"");
+    Token t = lexer.nextToken();
+    EXPECT_EQ(t.type, Token::STRING);
+    EXPECT_EQ(t.lexeme, text);
+}
+
+TEST(LexerTest, UnescapedControlCharactersAreInvalid)
+{
+    Token t = Lexer("\"x\ty\"").nextToken();
+    EXPECT_EQ(t.type, Token::INVALID);
+    EXPECT_EQ(t.pos, 2);
+    EXPECT_EQ(Lexer("\"x\x01y\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"" + std::string(40, 'x') + "\n\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer(std::string("\"\0\"", 3)).nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"x\\ty\"").nextToken().lexeme, "x\ty");
+}
+
+TEST(LexerTest, InvalidUtf8IsRejected)
+{
+    EXPECT_EQ(Lexer("\"abc\xC3\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\xED\xA0\x80\"").nextToken().type, Token::INVALID);
+    EXPECT_EQ(Lexer("\"\xC0\xAF\"").nextToken().type, Token::INVALID);
+}
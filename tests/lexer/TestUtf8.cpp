@@ -0,0 +1,98 @@
+#include "lexer/Utf8.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+static bool validateAll(const std::string &s)
+{
+    bool scalar = Utf8::validateScalar(s.data(), s.size());
+    EXPECT_EQ(Utf8::validate(s.data(), s.size()), scalar) << "Kernel mismatch";
+    return scalar;
+}
+
+TEST(Utf8Test, ValidSequences)
+{
+    EXPECT_TRUE(validateAll(""));
+    EXPECT_TRUE(validateAll("plain ascii"));
+    EXPECT_TRUE(validateAll("\xC2\x80 \xDF\xBF"));
+    EXPECT_TRUE(validateAll("\xE0\xA0\x80 \xED\x9F\xBF \xEF\xBF\xBF"));
+    EXPECT_TRUE(validateAll("\xF0\x90\x80\x80 \xF4\x8F\xBF\xBF"));
+}
+
+TEST(Utf8Test, InvalidSequences)
+{
+    EXPECT_FALSE(validateAll("\x80"));
+    EXPECT_FALSE(validateAll("\xC0\x80"));
+    EXPECT_FALSE(validateAll("\xC2"));
+    EXPECT_FALSE(validateAll("\xE0\x9F\xBF"));
+    EXPECT_FALSE(validateAll("\xED\xA0\x80"));
+    EXPECT_FALSE(validateAll("\xF0\x8F\xBF\xBF"));
+    EXPECT_FALSE(validateAll("\xF4\x90\x80\x80"));
+    EXPECT_FALSE(validateAll("\xF5\x80\x80\x80"));
+    EXPECT_FALSE(validateAll("abc\xE2\x82"));
+}
+
+TEST(Utf8Test, KernelsAgreeOnRandomInput)
+{
+    std::mt19937 rng(1234);
+    const std::vector<std::string> pieces = {
+        "a", "z", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xC3", "\xED\xA0\x80", "\xFF"};
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::string s;
+        size_t count = rng() % 40;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t pick = rng() % pieces.size();
+            s += pieces[pick < 5 || rng() % 8 == 0 ? pick : pick % 5];
+        }
+        validateAll(s);
+    }
+}
+
+TEST(Utf8Test, FindSpecial)
+{
+    std::string s = std::string(40, 'x') + "\xC3\xA9" + std::string(30, 'y') + "\"tail";
+    bool ascii = true;
+    EXPECT_EQ(Utf8::findSpecial(s.data(), 0, s.size(), ascii), 72);
+    EXPECT_FALSE(ascii);
+
+    ascii = true;
+    EXPECT_EQ(Utf8::findSpecial(s.data(), 42, s.size(), ascii), 72);
+    EXPECT_TRUE(ascii);
+
+    std::string none(50, 'q');
+    EXPECT_EQ(Utf8::findSpecial(none.data(), 0, none.size(), ascii), 50);
+}
+
+TEST(Utf8Test, FindSpecialStopsAtControlCharacters)
+{
+    for (char control : {'\0', '\t', '\n', '\x1F'})
+    {
+        for (size_t at = 0; at < 70; ++at)
+        {
+            std::string s = std::string(at, ' ') + control + std::string(70, '\x7F') + "\"";
+            bool ascii = true;
+            EXPECT_EQ(Utf8::findSpecial(s.data(), 0, s.size(), ascii), at) << int(control);
+            EXPECT_TRUE(ascii);
+        }
+    }
+}
+
+TEST(Utf8Test, DecodeHexAndEncode)
+{
+    EXPECT_EQ(Utf8::decodeHex4("00e9"), 0xE9);
+    EXPECT_EQ(Utf8::decodeHex4("FFFF"), 0xFFFF);
+    EXPECT_LT(Utf8::decodeHex4("12g4"), 0);
+
+    std::string out;
+    Utf8::append(out, 0x41);
+    Utf8::append(out, 0xE9);
+    Utf8::append(out, 0x20AC);
+    Utf8::append(out, 0x1F600);
+    EXPECT_EQ(out, "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+// Built with -fno-exceptions to check that the headers compile without
+// exception support and that tryParse() reports errors as values.
+
+#include "io/Sink.h"
+#include "json/Json.h"
+#include "parser/Parser.h"
+#include "parser/Projection.h"
+#include "snapshot/Snapshot.h"
+#include "transcoder/Transcoder.h"
+#include "validator/Validator.h"
+#include "writer/ParallelSerializer.h"
+#include "writer/Writer.h"
+
+#include <cstdio>
+
+int main()
+{
+    Parser parser;
+
+    auto ok = parser.tryParse(R"({"a": [1, 2, {"b": null}], "c": "d"})");
+    if (!ok || !(*ok)["a"].is_array())
+        return 1;
+
+    auto bad = parser.tryParse(R"({"a": [1, 2,]})");
+    if (bad || bad.error().code != ParseError::UNEXPECTED_TOKEN || bad.error().offset != 12)
+        return 2;
+
+    std::string out;
+    Writer<StringSink> writer{StringSink(out)};
+    writer.value(*ok);
+    writer.finish();
+    if (!parser.tryParse(out))
+        return 3;
+
+    if (ParallelSerializer(2, 1).dump(*ok).empty())
+        return 4;
+
+    std::puts("ok");
+    return 0;
+}
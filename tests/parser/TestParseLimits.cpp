@@ -0,0 +1,158 @@
+#include "parser/Parser.h"
+#include "parser/Projection.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+ParseError::Code failure(Parser &parser, std::string_view input)
+{
+    auto result = parser.tryParse(input);
+    EXPECT_FALSE(result.has_value()) << input;
+    return result ? ParseError::UNEXPECTED_TOKEN : result.error().code;
+}
+
+std::string array(size_t count)
+{
+    std::string s = "{\"a\": [";
+    for (size_t i = 0; i < count; ++i)
+        s += i ? ",0" : "0";
+    return s + "]}";
+}
+
+} // namespace
+
+TEST(ParseLimitsTest, DefaultsAreUnlimited)
+{
+    Parser parser;
+    EXPECT_EQ(parser.limits().max_elements, ParseLimits::unlimited);
+    EXPECT_TRUE(parser.tryParse(array(10000)).has_value());
+}
+
+TEST(ParseLimitsTest, InputBytes)
+{
+    Parser parser;
+    ParseLimits limits;
+    limits.max_input_bytes = 10;
+    parser.setLimits(limits);
+
+    EXPECT_TRUE(parser.tryParse("{\"a\": 12}").has_value());
+    auto result = parser.tryParse("{\"a\": 1234}");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, ParseError::INPUT_TOO_LARGE);
+    EXPECT_EQ(result.error().offset, 10u);
+
+    EXPECT_THROW(parser.parse("{\"a\": 1234}"), std::runtime_error);
+    EXPECT_THROW(parser.parseValue("12345678901"), std::runtime_error);
+    EXPECT_THROW(parser.parse("{\"a\": 12345}", Projection({"/a"})), std::runtime_error);
+}
+
+TEST(ParseLimitsTest, StringLengthCoversKeysAndValues)
+{
+    Parser parser;
+    ParseLimits limits;
+    limits.max_string_length = 4;
+    parser.setLimits(limits);
+
+    EXPECT_TRUE(parser.tryParse("{\"abcd\": \"\\u00e9\\u00e9\"}").has_value());
+    EXPECT_EQ(failure(parser, "{\"a\": \"abcde\"}"), ParseError::STRING_TOO_LONG);
+    EXPECT_EQ(failure(parser, "{\"abcde\": 1}"), ParseError::STRING_TOO_LONG);
+    EXPECT_EQ(parser.error().offset, 1u);
+}
+
+TEST(ParseLimitsTest, ElementCount)
+{
+    Parser parser;
+    ParseLimits limits;
+    // The root object, the array and its elements.
+    limits.max_elements = 102;
+    parser.setLimits(limits);
+
+    EXPECT_TRUE(parser.tryParse(array(100)).has_value());
+    EXPECT_EQ(failure(parser, array(101)), ParseError::TOO_MANY_ELEMENTS);
+
+    // The budget is per parse, not cumulative.
+    EXPECT_TRUE(parser.tryParse(array(100)).has_value());
+    EXPECT_TRUE(parser.tryParse(array(100)).has_value());
+}
+
+TEST(ParseLimitsTest, AllocatedBytes)
+{
+    Parser parser;
+    ParseLimits limits;
+    limits.max_allocated_bytes = 64 * 1024;
+    parser.setLimits(limits);
+
+    std::string small = "{\"s\": \"" + std::string(1000, 'x') + "\"}";
+    std::string big = "{\"s\": \"" + std::string(100000, 'x') + "\"}";
+    EXPECT_TRUE(parser.tryParse(small).has_value());
+    EXPECT_EQ(failure(parser, big), ParseError::MEMORY_LIMIT_EXCEEDED);
+    EXPECT_EQ(failure(parser, array(10000)), ParseError::MEMORY_LIMIT_EXCEEDED);
+
+    std::string keys = "{";
+    for (int i = 0; i < 5000; ++i)
+        keys += (i ? ",\"k" : "\"k") + std::to_string(i) + "\": null";
+    EXPECT_EQ(failure(parser, keys + "}"), ParseError::MEMORY_LIMIT_EXCEEDED);
+}
+
+TEST(ParseLimitsTest, Deadline)
+{
+    Parser parser;
+    ParseLimits limits;
+    limits.timeout = std::chrono::nanoseconds(1);
+    parser.setLimits(limits);
+    EXPECT_EQ(failure(parser, array(100000)), ParseError::DEADLINE_EXCEEDED);
+
+    limits.timeout = std::chrono::seconds(60);
+    parser.setLimits(limits);
+    EXPECT_TRUE(parser.tryParse(array(100000)).has_value());
+}
+
+TEST(ParseLimitsTest, LexingStopsAtTheFirstBrokenLimit)
+{
+    Parser parser;
+    ParseLimits limits;
+    limits.max_elements = 10;
+    parser.setLimits(limits);
+
+    // {, "a", :, [, then elements up to the ninth, which breaks the limit
+    // alongside the root object and the array, and their commas.
+    EXPECT_EQ(failure(parser, array(100000)), ParseError::TOO_MANY_ELEMENTS);
+    EXPECT_EQ(parser.tokens().size(), 4u + 2 * 9 - 1);
+    EXPECT_EQ(parser.tokens().back().type, Token::INTEGER);
+
+    limits.max_elements = ParseLimits::unlimited;
+    limits.max_string_length = 4;
+    parser.setLimits(limits);
+    EXPECT_EQ(failure(parser, "{\"a\": [\"abcde\"" + array(100000).substr(6)), ParseError::STRING_TOO_LONG);
+    EXPECT_EQ(parser.tokens().size(), 5u);
+
+    limits.max_string_length = ParseLimits::unlimited;
+    limits.timeout = std::chrono::nanoseconds(1);
+    parser.setLimits(limits);
+    EXPECT_EQ(failure(parser, array(100000)), ParseError::DEADLINE_EXCEEDED);
+    EXPECT_EQ(parser.tokens().size(), ParseLimits::deadline_interval);
+}
+
+TEST(ParseLimitsTest, DeepNestingFailsDuringValidation)
+{
+    Parser parser;
+    std::string deep = "{\"a\": " + std::string(100000, '[') + std::string(100000, ']') + "}";
+    auto result = parser.tryParse(deep);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, ParseError::DEPTH_EXCEEDED);
+    EXPECT_EQ(result.error().offset, 6u + Parser::default_max_depth - 1);
+    EXPECT_THROW(parser.parseValue(deep.substr(6, deep.size() - 7)), std::runtime_error);
+}
+
+TEST(ParseLimitsTest, ErrorMessagesNameTheLimit)
+{
+    EXPECT_STREQ((ParseError{ParseError::TOO_MANY_ELEMENTS, 0}).message(), "Element count limit exceeded");
+    EXPECT_EQ((ParseError{ParseError::DEADLINE_EXCEEDED, 7}).describe(),
+              "Invalid JSON: Parse deadline exceeded at offset 7");
+}
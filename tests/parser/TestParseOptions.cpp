@@ -0,0 +1,105 @@
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+struct DoubleOptions : DefaultParseOptions
+{
+    static constexpr bool integers_as_double = true;
+};
+
+struct LazyOptions : DefaultParseOptions
+{
+    static constexpr bool lazy_numbers = true;
+};
+
+struct ShallowOptions : DefaultParseOptions
+{
+    static constexpr size_t max_depth = 2;
+};
+
+struct NoUtf8Options : DefaultParseOptions
+{
+    static constexpr bool validate_utf8 = false;
+};
+
+TEST(ParseOptionsTest, DuplicateKeys)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"a": 1, "a": 2})");
+    EXPECT_EQ(result["a"].get<JsonValue::number_integer_t>(), 2);
+
+    StrictParser strict;
+    auto rejected = strict.tryParse(R"({"a": 1, "b": {"c": 1, "c": 2}})");
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().code, ParseError::DUPLICATE_KEY);
+    EXPECT_EQ(rejected.error().offset, 23);
+    EXPECT_TRUE(strict.tryParse(R"({"a": {"c": 1}, "b": {"c": 2}})").has_value());
+}
+
+TEST(ParseOptionsTest, IntegersAsDouble)
+{
+    BasicParser<DoubleOptions> parser;
+    Json result = parser.parse(R"({"a": 3, "b": [-7]})");
+    EXPECT_TRUE(result["a"].is_float());
+    EXPECT_DOUBLE_EQ(result["a"].get<JsonValue::number_float_t>(), 3.0);
+}
+
+TEST(ParseOptionsTest, LazyNumbers)
+{
+    BasicParser<LazyOptions> parser;
+    EXPECT_EQ(parser.numberMode(), BasicParser<LazyOptions>::RAW);
+    Json result = parser.parse(R"({"a": 1.10})");
+    EXPECT_EQ(result["a"].get<JsonValue::number_raw_t>().raw(), "1.10");
+
+    EXPECT_THROW(parser.setNumberMode(BasicParser<LazyOptions>::BINARY), std::invalid_argument);
+    EXPECT_NO_THROW(parser.setNumberMode(BasicParser<LazyOptions>::RAW));
+    EXPECT_EQ(parser.numberMode(), BasicParser<LazyOptions>::RAW);
+}
+
+TEST(ParseOptionsTest, MaxDepth)
+{
+    BasicParser<ShallowOptions> parser;
+    EXPECT_EQ(parser.maxDepth(), 2);
+    EXPECT_TRUE(parser.tryParse(R"({"a": [1]})").has_value());
+    EXPECT_EQ(parser.tryParse(R"({"a": [[1]]})").error().code, ParseError::DEPTH_EXCEEDED);
+}
+
+TEST(ParseOptionsTest, Utf8Validation)
+{
+    std::string input = "{\"a\": \"\xC3\x28\"}";
+    EXPECT_FALSE(Parser().tryParse(input).has_value());
+
+    BasicParser<NoUtf8Options> parser;
+    auto result = parser.tryParse(input);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ((*result)["a"].get<JsonValue::string_t>(), "\xC3\x28");
+}
+
+TEST(ParseOptionsTest, EveryPolicyRejectsControlCharacters)
+{
+    for (const char *input : {"{\"a\":\"x\ty\"}", "{\"a\":\"x\x01y\"}", "{\"a\tb\":1}"})
+    {
+        auto strict = StrictParser().tryParse(input);
+        ASSERT_FALSE(strict.has_value()) << input;
+        EXPECT_EQ(strict.error().code, ParseError::INVALID_TOKEN);
+        EXPECT_FALSE(Parser().tryParse(input).has_value()) << input;
+        EXPECT_FALSE(TrustedParser().tryParse(input).has_value()) << input;
+        EXPECT_FALSE(BasicParser<NoUtf8Options>().tryParse(input).has_value()) << input;
+    }
+    EXPECT_EQ(StrictParser().tryParse("{\"a\":\"x\ty\"}").error().offset, 7);
+    EXPECT_THROW(Parser().parse("{\"a\":\"x\ty\", \"b\": 1}", Projection{"/b"}), std::runtime_error);
+    EXPECT_EQ(Parser().parse(R"({"a":"x\ty"})")["a"].get<JsonValue::string_t>(), "x\ty");
+}
+
+TEST(ParseOptionsTest, TrustedInputSkipsValidation)
+{
+    TrustedParser trusted;
+    Json result = trusted.parse(R"({"a": [1, 2], "b": {"c": true}})");
+    EXPECT_EQ(result["a"].get<JsonValue::array_t>().size(), 2);
+    EXPECT_TRUE(static_cast<JsonValue::object_t>(result["b"])["c"].get<JsonValue::boolean_t>());
+
+    // Not checked, but still handled safely.
+    EXPECT_TRUE(trusted.tryParse(R"({"a": 1,})").has_value());
+    EXPECT_FALSE(trusted.tryParse(R"({"a": [1, 2)").has_value());
+    EXPECT_FALSE(Parser().tryParse(R"({"a": 1,})").has_value());
+}
@@ -1,6 +1,8 @@
 #include "parser/Parser.h"
 #include <gtest/gtest.h>
 
+#include <sstream>
+
 class ParserTest : public ::testing::Test
 {
 };
@@ -29,8 +31,32 @@ TEST_F(ParserTest, ValidNested)
     EXPECT_TRUE(parser.validate());
 }
 
+TEST_F(ParserTest, ValidStringValueInObject)
+{
+    Parser parser({Token(Token::LBRACE),
+                   Token(Token::STRING, "key"), Token(Token::COLON), Token(Token::STRING, "value"),
+                   Token(Token::RBRACE)});
+    EXPECT_TRUE(parser.validate());
+}
+
+TEST_F(ParserTest, ValidWithTrailingEofToken)
+{
+    Parser parser({Token(Token::LBRACE), Token(Token::RBRACE), Token(Token::EOFTOKEN)});
+    EXPECT_TRUE(parser.validate());
+}
+
 // ------------------- Invalid JSON -------------------
 
+TEST_F(ParserTest, InvalidValueInKeyPosition)
+{
+    Parser parser({Token(Token::LBRACE),
+                   Token(Token::STRING, "key"), Token(Token::COLON), Token(Token::INTEGER, "1"),
+                   Token(Token::COMMA),
+                   Token(Token::INTEGER, "2"), // {"key":1, 2}
+                   Token(Token::RBRACE)});
+    EXPECT_FALSE(parser.validate());
+}
+
 TEST_F(ParserTest, InvalidMissingClosingBrace)
 {
     Parser parser({Token(Token::LBRACE)});
@@ -152,3 +178,208 @@ TEST_F(ParserTest, BuildNonObjectRootThrows)
 
     EXPECT_THROW(parser.buildJson(), std::runtime_error);
 }
+
+// ------------------- Nesting depth -------------------
+
+static std::vector<Token> nestedArrays(size_t depth)
+{
+    std::vector<Token> tokens = {Token(Token::LBRACE), Token(Token::STRING, "root"), Token(Token::COLON)};
+    for (size_t i = 0; i < depth; ++i)
+        tokens.emplace_back(Token::LBRACKET);
+    tokens.emplace_back(Token::INTEGER, "7");
+    for (size_t i = 0; i < depth; ++i)
+        tokens.emplace_back(Token::RBRACKET);
+    tokens.emplace_back(Token::RBRACE);
+    return tokens;
+}
+
+TEST_F(ParserTest, BuildDeeplyNestedWithoutRecursion)
+{
+    Parser parser(nestedArrays(5000));
+    parser.setMaxDepth(6000);
+
+    Json result = parser.buildJson();
+    const JsonValue *v = &result["root"];
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        ASSERT_TRUE(v->is_array());
+        v = &v->get<JsonValue::array_t>()[0];
+    }
+    EXPECT_EQ(v->get<JsonValue::number_integer_t>(), 7);
+}
+
+TEST_F(ParserTest, BuildRespectsMaxDepth)
+{
+    Parser shallow(nestedArrays(10));
+    shallow.setMaxDepth(10);
+    EXPECT_THROW(shallow.buildJson(), std::runtime_error);
+
+    Parser deep(nestedArrays(10));
+    deep.setMaxDepth(11);
+    EXPECT_NO_THROW(deep.buildJson());
+}
+
+TEST_F(ParserTest, BuildObjectsInsideArrays)
+{
+    Parser parser({Token(Token::LBRACE),
+                   Token(Token::STRING, "list"), Token(Token::COLON),
+                   Token(Token::LBRACKET),
+                   Token(Token::LBRACE), Token(Token::STRING, "a"), Token(Token::COLON), Token(Token::INTEGER, "1"), Token(Token::RBRACE),
+                   Token(Token::COMMA),
+                   Token(Token::LBRACE), Token(Token::RBRACE),
+                   Token(Token::RBRACKET),
+                   Token(Token::COMMA),
+                   Token(Token::STRING, "b"), Token(Token::COLON), Token(Token::STRING, "x"),
+                   Token(Token::RBRACE)});
+
+    Json result = parser.buildJson();
+    const auto &list = result["list"].get<JsonValue::array_t>();
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_EQ(static_cast<JsonValue::number_integer_t>(static_cast<JsonValue::object_t>(list[0])["a"]), 1);
+    EXPECT_TRUE(list[1].get<JsonValue::object_t>().empty());
+    EXPECT_EQ(static_cast<JsonValue::string_t>(result["b"]), "x");
+}
+
+// ------------------- Move semantics -------------------
+
+TEST_F(ParserTest, TakeMovesStringsOutOfTokens)
+{
+    std::string longValue(64, 'x');
+    Parser parser({Token(Token::LBRACE),
+                   Token(Token::STRING, "key"), Token(Token::COLON), Token(Token::STRING, longValue),
+                   Token(Token::RBRACE)});
+
+    const char *buffer = parser.tokens()[3].lexeme.data();
+    Json result = parser.takeJson();
+
+    EXPECT_EQ(result["key"].get<JsonValue::string_t>(), longValue);
+    EXPECT_EQ(result["key"].get<JsonValue::string_t>().data(), buffer);
+}
+
+TEST_F(ParserTest, BuildLeavesTokensIntact)
+{
+    Parser parser({Token(Token::LBRACE),
+                   Token(Token::STRING, "key"), Token(Token::COLON), Token(Token::STRING, "value"),
+                   Token(Token::RBRACE)});
+
+    EXPECT_EQ(parser.buildJson()["key"].get<JsonValue::string_t>(), "value");
+    EXPECT_EQ(parser.tokens()[3].lexeme, "value");
+    EXPECT_EQ(parser.buildJson()["key"].get<JsonValue::string_t>(), "value");
+    EXPECT_EQ(parser.takeJson()["key"].get<JsonValue::string_t>(), "value");
+}
+
+TEST_F(ParserTest, TakeTwiceThrows)
+{
+    Parser parser({Token(Token::LBRACE), Token(Token::RBRACE)});
+    EXPECT_NO_THROW(parser.takeJson());
+    EXPECT_THROW(parser.takeJson(), std::logic_error);
+    EXPECT_THROW(parser.buildJson(), std::logic_error);
+}
+
+// ------------------- Reusable parse -------------------
+
+TEST_F(ParserTest, ParseFromText)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"name": "Alice", "tags": ["a", "b"], "age": 30, "ok": true})");
+
+    EXPECT_EQ(result["name"].get<JsonValue::string_t>(), "Alice");
+    EXPECT_EQ(result["tags"].get<JsonValue::array_t>().size(), 2);
+    EXPECT_EQ(result["age"].get<JsonValue::number_integer_t>(), 30);
+    EXPECT_TRUE(result["ok"].get<JsonValue::boolean_t>());
+}
+
+TEST_F(ParserTest, ParseReusesBuffers)
+{
+    Parser parser;
+    parser.parse(R"({"a": [1, 2, 3], "b": {"c": "d"}})");
+    const Token *storage = parser.tokens().data();
+
+    Json result = parser.parse(R"({"x": [4, 5], "y": {"z": "w"}})");
+    EXPECT_EQ(parser.tokens().data(), storage);
+    EXPECT_EQ(result["y"].get<JsonValue::object_t>().begin()->first, "z");
+}
+
+TEST_F(ParserTest, ParseRecoversAfterInvalidInput)
+{
+    Parser parser;
+    EXPECT_THROW(parser.parse(R"({"a": })"), std::runtime_error);
+
+    Json result = parser.parse(R"({"a": 1})");
+    EXPECT_EQ(result["a"].get<JsonValue::number_integer_t>(), 1);
+}
+
+// ------------------- Raw numbers -------------------
+
+TEST_F(ParserTest, RawNumbersRoundTrip)
+{
+    Parser parser;
+    parser.setNumberMode(Parser::RAW);
+    Json result = parser.parse(R"({"id": 123456789012345678901234567890, "pi": 3.141592653589793, "n": [-0, 1E+2]})");
+
+    EXPECT_TRUE(result["id"].is_raw_number());
+    EXPECT_EQ(result["id"].get<JsonValue::number_raw_t>().raw(), "123456789012345678901234567890");
+    EXPECT_DOUBLE_EQ(static_cast<double>(result["pi"]), 3.141592653589793);
+
+    std::ostringstream os;
+    os << result["pi"] << ' ' << result["n"];
+    EXPECT_EQ(os.str(), "3.141592653589793 [-0, 1E+2]");
+}
+
+TEST_F(ParserTest, BinaryNumbersByDefault)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"a": 1, "b": 2.5})");
+    EXPECT_TRUE(result["a"].is_integer());
+    EXPECT_TRUE(result["b"].is_float());
+}
+
+// ------------------- Non-throwing parse -------------------
+
+TEST_F(ParserTest, TryParseSucceeds)
+{
+    Parser parser;
+    auto result = parser.tryParse(R"({"a": [1, 2.5, "x"], "big": 9007199254740993})");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ((*result)["a"].get<JsonValue::array_t>().size(), 3);
+    EXPECT_EQ((*result)["big"].get<JsonValue::number_integer_t>(), 9007199254740993);
+}
+
+TEST_F(ParserTest, TryParseReportsCodeAndOffset)
+{
+    Parser parser;
+    auto check = [&](std::string_view input, ParseError::Code code, size_t offset)
+    {
+        auto result = parser.tryParse(input);
+        ASSERT_FALSE(result.has_value()) << input;
+        EXPECT_EQ(result.error().code, code) << input;
+        EXPECT_EQ(result.error().offset, offset) << input;
+    };
+
+    check(R"({"a": })", ParseError::UNEXPECTED_TOKEN, 6);
+    check(R"({"a": 1 "b": 2})", ParseError::UNEXPECTED_TOKEN, 8);
+    check(R"({"a": tru})", ParseError::INVALID_TOKEN, 6);
+    check(R"({"a": [1, 2)", ParseError::UNEXPECTED_END, 11);
+    check(R"([1, 2])", ParseError::ROOT_NOT_OBJECT, 0);
+    check(R"({} {})", ParseError::UNEXPECTED_TOKEN, 3);
+    check(R"({"a": 99999999999999999999})", ParseError::NUMBER_OUT_OF_RANGE, 6);
+    check("", ParseError::UNEXPECTED_END, 0);
+
+    parser.setMaxDepth(2);
+    check(R"({"a": {"b": {}}})", ParseError::DEPTH_EXCEEDED, 12);
+}
+
+TEST_F(ParserTest, ThrowingParseCarriesPosition)
+{
+    Parser parser;
+    try
+    {
+        parser.parse(R"({"a": })");
+        FAIL() << "expected an exception";
+    }
+    catch (const std::runtime_error &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Invalid JSON: Unexpected token at offset 6");
+    }
+    EXPECT_EQ(parser.error().code, ParseError::UNEXPECTED_TOKEN);
+}
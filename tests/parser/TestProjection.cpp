@@ -0,0 +1,151 @@
+#include "parser/Parser.h"
+#include "parser/Projection.h"
+
+#include <gtest/gtest.h>
+
+static const char *event = R"({
+    "user": {"id": 42, "name": "Alice", "tags": ["a", "b"]},
+    "items": [
+        {"sku": "A-1", "qty": 2, "meta": {"x": [1, 2, {"y": "}]\"["}]}},
+        {"qty": 5},
+        {"sku": "B-2", "qty": 1}
+    ],
+    "meta": {"ts": 1700000000, "source": "web"},
+    "payload": {"huge": [[[[["skipped"]]]]], "text": "{not: [json"}
+})";
+
+TEST(ProjectionTest, SelectsRequestedPathsOnly)
+{
+    Parser parser;
+    Json result = parser.parse(event, Projection{"/user/id", "/meta/ts"});
+
+    EXPECT_EQ(result["user"].get<JsonValue::object_t>().begin()->first, "id");
+    EXPECT_EQ(static_cast<JsonValue::object_t>(result["user"])["id"].get<JsonValue::number_integer_t>(), 42);
+    EXPECT_EQ(static_cast<JsonValue::object_t>(result["meta"])["ts"].get<JsonValue::number_integer_t>(), 1700000000);
+
+    size_t keys = 0;
+    for (const auto &kv : result)
+    {
+        EXPECT_TRUE(kv.first == "user" || kv.first == "meta");
+        ++keys;
+    }
+    EXPECT_EQ(keys, 2);
+}
+
+TEST(ProjectionTest, WildcardOverArray)
+{
+    Parser parser;
+    Json result = parser.parse(event, Projection{"/items/*/sku"});
+
+    const auto &items = result["items"].get<JsonValue::array_t>();
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_EQ(static_cast<JsonValue::object_t>(items[0])["sku"].get<JsonValue::string_t>(), "A-1");
+    EXPECT_TRUE(items[1].get<JsonValue::object_t>().empty());
+    EXPECT_EQ(static_cast<JsonValue::object_t>(items[2])["sku"].get<JsonValue::string_t>(), "B-2");
+}
+
+TEST(ProjectionTest, ArrayIndexAndWholeSubtree)
+{
+    Parser parser;
+    Json result = parser.parse(event, Projection{"/items/0/meta", "/user/tags"});
+
+    const auto &items = result["items"].get<JsonValue::array_t>();
+    ASSERT_EQ(items.size(), 1);
+    auto meta = static_cast<JsonValue::object_t>(static_cast<JsonValue::object_t>(items[0])["meta"]);
+    const auto &x = meta["x"].get<JsonValue::array_t>();
+    ASSERT_EQ(x.size(), 3);
+    EXPECT_EQ(static_cast<JsonValue::object_t>(x[2])["y"].get<JsonValue::string_t>(), "}]\"[");
+
+    auto user = static_cast<JsonValue::object_t>(result["user"]);
+    EXPECT_EQ(user["tags"].get<JsonValue::array_t>().size(), 2);
+}
+
+TEST(ProjectionTest, MissingPathsAndScalarMismatch)
+{
+    Parser parser;
+    Json result = parser.parse(event, Projection{"/absent", "/meta/source/deeper"});
+
+    EXPECT_TRUE(result["meta"].get<JsonValue::object_t>().empty());
+}
+
+TEST(ProjectionTest, EscapedKeysAndPointerEscapes)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"a\/b": 1, "c~d": 2, "ef": 3})", Projection{"/a~1b", "/c~0d", "/ef"});
+
+    EXPECT_EQ(result["a/b"].get<JsonValue::number_integer_t>(), 1);
+    EXPECT_EQ(result["c~d"].get<JsonValue::number_integer_t>(), 2);
+    EXPECT_EQ(result["ef"].get<JsonValue::number_integer_t>(), 3);
+}
+
+TEST(ProjectionTest, OverlappingLiteralAndWildcardKeys)
+{
+    Parser parser;
+    const char *input = R"({"a": {"x": 1, "y": 2, "z": 3}, "b": {"y": 4, "z": 5}})";
+
+    for (const Projection &projection : {Projection{"/a/x", "/*/y"}, Projection{"/*/y", "/a/x"}})
+    {
+        Json result = parser.parse(input, projection);
+
+        auto a = static_cast<JsonValue::object_t>(result["a"]);
+        EXPECT_EQ(a.size(), 2);
+        EXPECT_EQ(a["x"].get<JsonValue::number_integer_t>(), 1);
+        EXPECT_EQ(a["y"].get<JsonValue::number_integer_t>(), 2);
+
+        auto b = static_cast<JsonValue::object_t>(result["b"]);
+        EXPECT_EQ(b.size(), 1);
+        EXPECT_EQ(b["y"].get<JsonValue::number_integer_t>(), 4);
+    }
+}
+
+TEST(ProjectionTest, OverlappingIndexAndWildcard)
+{
+    Parser parser;
+    Json result = parser.parse(event, Projection{"/items/0/meta", "/items/*/sku"});
+
+    const auto &items = result["items"].get<JsonValue::array_t>();
+    ASSERT_EQ(items.size(), 3);
+    auto first = static_cast<JsonValue::object_t>(items[0]);
+    EXPECT_EQ(first.size(), 2);
+    EXPECT_EQ(first["sku"].get<JsonValue::string_t>(), "A-1");
+    EXPECT_TRUE(first["meta"].is_object());
+    EXPECT_TRUE(items[1].get<JsonValue::object_t>().empty());
+    EXPECT_EQ(static_cast<JsonValue::object_t>(items[2])["sku"].get<JsonValue::string_t>(), "B-2");
+}
+
+TEST(ProjectionTest, NestedWildcardsMergeIntoLiterals)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"a": {"b": {"c": 1, "d": 2}, "e": {"c": 3, "d": 4}}, "f": {"b": {"c": 5, "d": 6}}})",
+                               Projection{"/a/b/c", "/*/*/d", "/a/e"});
+
+    auto a = static_cast<JsonValue::object_t>(result["a"]);
+    auto ab = static_cast<JsonValue::object_t>(a["b"]);
+    EXPECT_EQ(ab.size(), 2);
+    EXPECT_EQ(ab["c"].get<JsonValue::number_integer_t>(), 1);
+    EXPECT_EQ(ab["d"].get<JsonValue::number_integer_t>(), 2);
+    EXPECT_EQ(a["e"].get<JsonValue::object_t>().size(), 2);
+
+    auto fb = static_cast<JsonValue::object_t>(static_cast<JsonValue::object_t>(result["f"])["b"]);
+    EXPECT_EQ(fb.size(), 1);
+    EXPECT_EQ(fb["d"].get<JsonValue::number_integer_t>(), 6);
+}
+
+TEST(ProjectionTest, EmptyPathSelectsWholeDocument)
+{
+    Parser parser;
+    Json result = parser.parse(R"({"a": 1, "b": [true]})", Projection{""});
+
+    EXPECT_EQ(result["a"].get<JsonValue::number_integer_t>(), 1);
+    EXPECT_TRUE(result["b"].is_array());
+}
+
+TEST(ProjectionTest, InvalidInputThrows)
+{
+    Parser parser;
+    EXPECT_THROW(parser.parse(R"({"a": [1, 2)", Projection{"/b"}), std::runtime_error);
+    EXPECT_THROW(parser.parse(R"({"a": 1 "b": 2})", Projection{"/b"}), std::runtime_error);
+    EXPECT_THROW(parser.parse(R"({"b": [1,]})", Projection{"/b"}), std::runtime_error);
+    EXPECT_THROW(parser.parse(R"([1])", Projection{"/b"}), std::runtime_error);
+    EXPECT_THROW(Projection{"no-slash"}, std::invalid_argument);
+}
@@ -0,0 +1,176 @@
+#include "parser/Parser.h"
+#include "snapshot/Snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+static Json sampleDocument()
+{
+    Json j;
+    j["name"] = "reference";
+    j["count"] = 42;
+    j["ratio"] = 0.25;
+    j["enabled"] = true;
+    j["missing"] = nullptr;
+    j["items"] = JsonValue::array_t{1, "two", 3.5, false};
+    j["nested"] = JsonValue::object_t{{"z", 1}, {"a", JsonValue::object_t{{"deep", "value"}}}};
+    return j;
+}
+
+TEST(SnapshotTest, RootIsObject)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+    SnapshotView view(bytes);
+
+    EXPECT_TRUE(view.root().is_object());
+    EXPECT_EQ(view.root().size(), 7);
+}
+
+TEST(SnapshotTest, ScalarLookup)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+    SnapshotValue root = SnapshotView(bytes).root();
+
+    EXPECT_EQ(root["name"].as_string(), "reference");
+    EXPECT_EQ(root["count"].as_integer(), 42);
+    EXPECT_DOUBLE_EQ(root["ratio"].as_float(), 0.25);
+    EXPECT_TRUE(root["enabled"].as_boolean());
+    EXPECT_TRUE(root["missing"].is_null());
+    EXPECT_FALSE(root.contains("absent"));
+    EXPECT_THROW(root["absent"], std::out_of_range);
+}
+
+TEST(SnapshotTest, KeysAreSorted)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+    SnapshotValue root = SnapshotView(bytes).root();
+
+    for (size_t i = 1; i < root.size(); ++i)
+        EXPECT_LT(root.key(i - 1), root.key(i));
+}
+
+TEST(SnapshotTest, NestedContainers)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+    SnapshotValue root = SnapshotView(bytes).root();
+
+    SnapshotValue items = root["items"];
+    ASSERT_TRUE(items.is_array());
+    ASSERT_EQ(items.size(), 4);
+    EXPECT_EQ(items[0].as_integer(), 1);
+    EXPECT_EQ(items[1].as_string(), "two");
+    EXPECT_DOUBLE_EQ(items[2].as_float(), 3.5);
+    EXPECT_FALSE(items[3].as_boolean());
+
+    EXPECT_EQ(root["nested"]["a"]["deep"].as_string(), "value");
+    EXPECT_EQ(root["nested"]["z"].as_integer(), 1);
+}
+
+TEST(SnapshotTest, RawNumbersKeepTheirDigits)
+{
+    Parser parser;
+    parser.setNumberMode(Parser::RAW);
+    Json j = parser.parse(R"({"i": -42, "f": 0.25, "big": 123456789012345678901234567890, "huge": 1e400, "tiny": -1e-400})");
+    SnapshotValue root = SnapshotView(SnapshotWriter().write(j)).root();
+
+    EXPECT_EQ(root["i"].as_integer(), -42);
+    EXPECT_DOUBLE_EQ(root["f"].as_float(), 0.25);
+    ASSERT_TRUE(root["big"].is_raw_number());
+    EXPECT_EQ(root["big"].as_raw_number(), "123456789012345678901234567890");
+    EXPECT_EQ(root["huge"].as_raw_number(), "1e400");
+    EXPECT_EQ(root["tiny"].as_raw_number(), "-1e-400");
+    EXPECT_THROW(root["big"].as_float(), std::runtime_error);
+    EXPECT_THROW(root["i"].as_raw_number(), std::runtime_error);
+}
+
+TEST(SnapshotTest, RejectsCorruptHeader)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+
+    EXPECT_THROW(SnapshotView(std::string_view(bytes.data(), 8)), std::runtime_error);
+
+    std::string truncated = bytes.substr(0, bytes.size() - 8);
+    EXPECT_THROW(SnapshotView{truncated}, std::runtime_error);
+
+    bytes[0] = 'X';
+    EXPECT_THROW(SnapshotView{bytes}, std::runtime_error);
+}
+
+TEST(SnapshotTest, WrongTypeAndIndexThrow)
+{
+    SnapshotWriter writer;
+    std::string bytes = writer.write(sampleDocument());
+    SnapshotValue root = SnapshotView(bytes).root();
+
+    EXPECT_THROW(root["count"].as_string(), std::runtime_error);
+    EXPECT_THROW(root["name"].as_integer(), std::runtime_error);
+    EXPECT_THROW(root["name"].size(), std::runtime_error);
+    EXPECT_THROW(root["items"]["x"], std::runtime_error);
+    EXPECT_THROW(root[size_t(0)], std::runtime_error);
+    EXPECT_THROW(root["items"][4], std::out_of_range);
+    EXPECT_THROW(root.key(7), std::out_of_range);
+    EXPECT_THROW(root.value(7), std::out_of_range);
+}
+
+TEST(SnapshotTest, CorruptNodesThrowOnAccess)
+{
+    Json j;
+    j["s"] = "abc";
+    j["a"] = JsonValue::array_t{1};
+    std::string bytes = SnapshotWriter().write(j);
+
+    // The string node sits right before its bytes; the array node is the
+    // one with type ARRAY and one element.
+    size_t string = bytes.find("abc") - Snapshot::node_size;
+    size_t array = 0;
+    for (size_t i = Snapshot::header_size; i < bytes.size(); i += 8)
+        if (Snapshot::load<uint32_t>(bytes.data() + i) == Snapshot::ARRAY)
+            array = i;
+    ASSERT_NE(array, 0u);
+
+    std::string longString = bytes;
+    uint64_t length = bytes.size();
+    std::memcpy(longString.data() + string + 8, &length, sizeof(length));
+    EXPECT_THROW(SnapshotView(longString).root()["s"].as_string(), std::runtime_error);
+
+    for (int64_t offset : {int64_t(-1) << 40, int64_t(4), int64_t(bytes.size())})
+    {
+        std::string badChild = bytes;
+        std::memcpy(badChild.data() + array + Snapshot::node_size, &offset, sizeof(offset));
+        SnapshotValue a = SnapshotView(badChild).root()["a"];
+        EXPECT_THROW(a[0], std::runtime_error) << offset;
+    }
+
+    std::string bigArray = bytes;
+    uint64_t count = uint64_t(1) << 60;
+    std::memcpy(bigArray.data() + array + 8, &count, sizeof(count));
+    EXPECT_THROW(SnapshotView(bigArray).root()["a"][count - 1], std::runtime_error);
+
+    std::string badType = bytes;
+    uint32_t type = 99;
+    std::memcpy(badType.data() + array, &type, sizeof(type));
+    EXPECT_THROW(SnapshotView(badType).root()["a"], std::runtime_error);
+}
+
+TEST(SnapshotTest, MappedFileRoundTrip)
+{
+    std::string path = testing::TempDir() + "libjson_snapshot_test.bin";
+    SnapshotWriter().writeFile(sampleDocument(), path);
+
+    {
+        SnapshotFile file(path);
+        SnapshotValue root = file.view().root();
+        EXPECT_EQ(root["count"].as_integer(), 42);
+        EXPECT_EQ(root["items"][1].as_string(), "two");
+    }
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,101 @@
+#include "transcoder/Transcoder.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+static std::string minify(std::string_view input, size_t bufferSize = Transcoder<StringSink>::default_buffer_size)
+{
+    std::string out;
+    Transcoder<StringSink> t(StringSink(out), Transcoder<StringSink>::MINIFY, 2, bufferSize);
+    t.feed(input);
+    t.finish();
+    return out;
+}
+
+static std::string pretty(std::string_view input)
+{
+    std::string out;
+    Transcoder<StringSink> t(StringSink(out), Transcoder<StringSink>::PRETTY);
+    t.feed(input);
+    t.finish();
+    return out;
+}
+
+TEST(TranscoderTest, MinifyStripsWhitespace)
+{
+    EXPECT_EQ(minify(" { \"a\" : [ 1 , 2.5 ,\n\ttrue ] ,\r\n \"b\" : null } "),
+              "{\"a\":[1,2.5,true],\"b\":null}");
+}
+
+TEST(TranscoderTest, MinifyPreservesStringsAndKeyOrder)
+{
+    std::string input = "{ \"z key\" : \"spaced  out \\\" quote\" , \"a\" : \"\\\\\" }";
+    EXPECT_EQ(minify(input), "{\"z key\":\"spaced  out \\\" quote\",\"a\":\"\\\\\"}");
+}
+
+TEST(TranscoderTest, ChunkBoundariesDoNotMatter)
+{
+    std::string input = "{ \"long key with spaces and \\\"escapes\\\"\" : [ 123456 , \"x y\" , { } ] }";
+    std::string expected = minify(input);
+
+    std::string out;
+    Transcoder<StringSink> t{StringSink(out)};
+    for (char c : input)
+        t.feed(std::string_view(&c, 1));
+    t.finish();
+    EXPECT_EQ(out, expected);
+}
+
+TEST(TranscoderTest, SmallBufferFlushesIncrementally)
+{
+    std::string input = "[ \"abcdefghijklmnopqrstuvwxyz\" , 1 , 2 , 3 ]";
+    EXPECT_EQ(minify(input, 4), minify(input));
+
+    size_t writes = 0;
+    Transcoder<CallbackSink> t(CallbackSink([&](const char *, size_t size)
+                                            {
+                                                EXPECT_LE(size, 32u);
+                                                ++writes; }),
+                               Transcoder<CallbackSink>::MINIFY, 2, 8);
+    t.feed(input);
+    t.finish();
+    EXPECT_GT(writes, 1u);
+}
+
+TEST(TranscoderTest, PrettyPrint)
+{
+    EXPECT_EQ(pretty("{\"a\":[1,{\"b\":null}],\"c\":{},\"d\":[]}"),
+              "{\n"
+              "  \"a\": [\n"
+              "    1,\n"
+              "    {\n"
+              "      \"b\": null\n"
+              "    }\n"
+              "  ],\n"
+              "  \"c\": {},\n"
+              "  \"d\": []\n"
+              "}");
+}
+
+TEST(TranscoderTest, PrettyThenMinifyRoundTrips)
+{
+    std::string input = "{\"k\":[true,false,{\"x\":\"a, b: {c}\"}],\"n\":-1.5e3}";
+    EXPECT_EQ(minify(pretty(input)), input);
+}
+
+TEST(TranscoderTest, FeedFromStream)
+{
+    std::string input;
+    for (int i = 0; i < 5000; ++i)
+        input += " { \"i\" : " + std::to_string(i) + " } ,";
+    input = "[" + input.substr(0, input.size() - 1) + "]";
+
+    std::istringstream in(input);
+    std::ostringstream os;
+    Transcoder<OstreamSink> t(OstreamSink(os), Transcoder<OstreamSink>::MINIFY, 2, 1024);
+    t.feed(in);
+    t.finish();
+    EXPECT_EQ(os.str(), minify(input));
+}
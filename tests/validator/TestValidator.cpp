@@ -0,0 +1,110 @@
+#include "validator/Validator.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+// ------------------- Valid JSON -------------------
+
+TEST(ValidatorTest, ValidContainers)
+{
+    Validator v;
+    EXPECT_TRUE(v.validate("{}"));
+    EXPECT_TRUE(v.validate("[]"));
+    EXPECT_TRUE(v.validate("  {\"a\": [1, 2, {\"b\": null}], \"c\": true }  "));
+    EXPECT_TRUE(v.validate("[-0, 0.5, 1e10, -2.5E-3, 123, false, \"x\"]"));
+}
+
+TEST(ValidatorTest, ValidStrings)
+{
+    Validator v;
+    EXPECT_TRUE(v.validate(R"(["escapes \" \\ \/ \b \f \n \r \t"])"));
+    EXPECT_TRUE(v.validate(R"(["é😀"])"));
+    EXPECT_TRUE(v.validate("[\"caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\"]"));
+    EXPECT_TRUE(v.validate("[\"a long ascii string that spans several eight byte words\"]"));
+}
+
+// ------------------- Invalid JSON -------------------
+
+TEST(ValidatorTest, InvalidStructureReportsOffset)
+{
+    Validator v;
+
+    ValidationResult r = v.validate("[1,]");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 3);
+
+    r = v.validate("{\"a\" 1}");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 5);
+
+    r = v.validate("[1 2]");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 3);
+
+    r = v.validate("[1}");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 2);
+}
+
+TEST(ValidatorTest, InvalidTopLevel)
+{
+    Validator v;
+    EXPECT_FALSE(v.validate(""));
+    EXPECT_FALSE(v.validate("\"abc\""));
+    EXPECT_FALSE(v.validate("{} {}"));
+
+    ValidationResult r = v.validate("{\"a\": 1");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 7);
+}
+
+TEST(ValidatorTest, InvalidScalars)
+{
+    Validator v;
+    EXPECT_FALSE(v.validate("[01]"));
+    EXPECT_FALSE(v.validate("[1.]"));
+    EXPECT_FALSE(v.validate("[1e]"));
+    EXPECT_FALSE(v.validate("[-]"));
+    EXPECT_FALSE(v.validate("[truely]"));
+    EXPECT_FALSE(v.validate("[nul]"));
+    EXPECT_FALSE(v.validate(R"(["\x"])"));
+    EXPECT_FALSE(v.validate(R"(["\u12G4"])"));
+    EXPECT_FALSE(v.validate("[\"tab\there\"]"));
+}
+
+TEST(ValidatorTest, InvalidUtf8)
+{
+    Validator v;
+    EXPECT_FALSE(v.validate("[\"\x80\"]"));
+    EXPECT_FALSE(v.validate("[\"\xC0\xAF\"]"));
+    EXPECT_FALSE(v.validate("[\"\xE0\x80\xAF\"]"));
+    EXPECT_FALSE(v.validate("[\"\xED\xA0\x80\"]"));
+    EXPECT_FALSE(v.validate("[\"\xF4\x90\x80\x80\"]"));
+
+    ValidationResult r = v.validate("[\"abcdefghij\xC3\"]");
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 13);
+}
+
+TEST(ValidatorTest, MaxDepth)
+{
+    std::string deep(10, '[');
+    deep += std::string(10, ']');
+
+    EXPECT_TRUE(Validator(10).validate(deep));
+
+    ValidationResult r = Validator(9).validate(deep);
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.offset, 9);
+}
+
+TEST(ValidatorTest, DepthIsClampedToSupportedMaximum)
+{
+    Validator v(1u << 20);
+    EXPECT_EQ(v.maxDepth(), Validator::max_supported_depth);
+
+    std::string deep(Validator::max_supported_depth, '[');
+    deep += std::string(Validator::max_supported_depth, ']');
+    EXPECT_TRUE(v.validate(deep));
+}
@@ -0,0 +1,74 @@
+#include "writer/ParallelSerializer.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+static std::string sequential(const Json &json)
+{
+    std::ostringstream os;
+    os << json;
+    return os.str();
+}
+
+static Json sample()
+{
+    JsonValue::array_t rows;
+    for (int i = 0; i < 2000; ++i)
+    {
+        Json row{{"id", i}, {"name", "row" + std::to_string(i)}, {"score", i * 0.25}, {"ok", i % 2 == 0}};
+        if (i % 100 == 0)
+            row["nested"] = JsonValue::array_t(300, JsonValue(i));
+        rows.push_back(std::move(row));
+    }
+
+    Json wide;
+    for (int i = 0; i < 500; ++i)
+        wide["k" + std::to_string(i)] = JsonValue{i, nullptr, "v"};
+
+    return Json{{"rows", std::move(rows)}, {"wide", std::move(wide)}, {"meta", Json{{"count", 2000}}}, {"empty", JsonValue::array_t{}}};
+}
+
+TEST(ParallelSerializerTest, MatchesSequentialOutput)
+{
+    Json doc = sample();
+    std::string expected = sequential(doc);
+
+    for (size_t chunk : {1, 7, 64, 4096, 1000000})
+    {
+        ParallelSerializer serializer(4, chunk);
+        EXPECT_EQ(serializer.dump(doc), expected) << "chunk size " << chunk;
+    }
+}
+
+TEST(ParallelSerializerTest, SplitsLargeContainers)
+{
+    Json doc = sample();
+    ParallelSerializer serializer(4, 64);
+    EXPECT_GT(serializer.serialize(doc).size(), 50);
+
+    ParallelSerializer single(4, 1000000);
+    EXPECT_EQ(single.serialize(doc).size(), 3);
+}
+
+TEST(ParallelSerializerTest, ScalarsAndSmallValues)
+{
+    ParallelSerializer serializer(2, 4);
+    EXPECT_EQ(serializer.dump(JsonValue(1.5)), "1.5");
+    EXPECT_EQ(serializer.dump(Json{}), "{}");
+
+    JsonValue arr = JsonValue::array_t{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::ostringstream os;
+    os << arr;
+    EXPECT_EQ(serializer.dump(arr), os.str());
+}
+
+TEST(ParallelSerializerTest, WritesToSink)
+{
+    Json doc = sample();
+    std::string out;
+    StringSink sink(out);
+    ParallelSerializer(3, 32).write(doc, sink);
+    EXPECT_EQ(out, sequential(doc));
+}
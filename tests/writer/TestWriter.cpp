@@ -0,0 +1,113 @@
+#include "writer/Writer.h"
+#include "parser/Parser.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(WriterTest, WritesNestedDocument)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    w.begin_object()
+        .key("name").value("Alice")
+        .key("age").value(30)
+        .key("score").value(0.1)
+        .key("tags").begin_array().value(true).value(nullptr).value(-7LL).end_array()
+        .key("empty").begin_object().end_object()
+        .end_object();
+    w.finish();
+
+    EXPECT_EQ(out, R"({"name":"Alice","age":30,"score":0.1,"tags":[true,null,-7],"empty":{}})");
+}
+
+TEST(WriterTest, EscapesStrings)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    w.begin_array()
+        .value(std::string("quote \" backslash \\ newline \n tab \t ctrl \x01 long enough for a vector pass"))
+        .value("caf\xC3\xA9")
+        .end_array();
+    w.finish();
+
+    EXPECT_EQ(out, "[\"quote \\\" backslash \\\\ newline \\n tab \\t ctrl \\u0001 long enough for a vector pass\","
+                   "\"caf\xC3\xA9\"]");
+}
+
+TEST(WriterTest, NumbersRoundTrip)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    w.begin_array().value(INT64_MIN).value(1e300).value(0.30000000000000004).value(JsonNumber("1.50")).end_array();
+    w.finish();
+
+    EXPECT_EQ(out, "[-9223372036854775808,1e+300,0.30000000000000004,1.50]");
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).value(std::nan("")), std::invalid_argument);
+}
+
+TEST(WriterTest, RawAndDomValues)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    Json inner{{"k", JsonValue{1, "two"}}};
+    w.begin_object().key("pre").raw(R"({"x":[1,2]})").key("dom").value(inner).end_object();
+    w.finish();
+
+    EXPECT_EQ(out, R"({"pre":{"x":[1,2]},"dom":{"k":[1,"two"]}})");
+}
+
+TEST(WriterTest, BoundedBufferFlushesThroughSink)
+{
+    std::vector<size_t> writes;
+    std::string out;
+    Writer<CallbackSink> w(CallbackSink([&](const char *data, size_t size)
+                                        {
+                                            writes.push_back(size);
+                                            out.append(data, size);
+                                        }),
+                           64);
+    w.begin_array();
+    for (int i = 0; i < 1000; ++i)
+        w.value("item");
+    w.end_array();
+    w.finish();
+
+    EXPECT_GT(writes.size(), 10);
+    for (size_t size : writes)
+        EXPECT_LE(size, 64);
+
+    Parser parser;
+    Json doc = parser.parse("{\"a\":" + out + "}");
+    EXPECT_EQ(doc["a"].get<JsonValue::array_t>().size(), 1000);
+}
+
+TEST(WriterTest, DeepNesting)
+{
+    std::string out;
+    Writer<StringSink> w{StringSink(out)};
+    for (int i = 0; i < 200; ++i)
+        (i % 2 ? w.begin_array() : w.begin_object().key("k"));
+    w.value(1);
+    for (int i = 199; i >= 0; --i)
+        (i % 2 ? w.end_array() : w.end_object());
+    w.finish();
+
+    EXPECT_TRUE(w.complete());
+    EXPECT_EQ(w.depth(), 0);
+    EXPECT_EQ(out.size(), 200 * 2 + 100 * 4 + 1);
+}
+
+TEST(WriterTest, RejectsMisuse)
+{
+    std::string out;
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).key("a"), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).begin_object().value(1), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).begin_object().key("a").key("b"), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).begin_object().key("a").end_object(), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).begin_array().end_object(), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).end_array(), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).value(1).value(2), std::logic_error);
+    EXPECT_THROW(Writer<StringSink>(StringSink(out)).begin_array().finish(), std::logic_error);
+}
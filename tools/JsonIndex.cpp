@@ -0,0 +1,149 @@
+// Builds and queries sidecar element indexes (see index/ElementIndex.h).
+//
+//   libjson_index build FILE [--ndjson] [--keys] [--index SIDECAR]
+//   libjson_index get FILE FIRST [COUNT] [--index SIDECAR] [--check]
+//   libjson_index find FILE KEY [--index SIDECAR]
+//   libjson_index info FILE [--index SIDECAR]
+//
+// The sidecar defaults to FILE.idx. get prints the requested elements one
+// per line; --check parses each before printing. find lists the elements
+// whose fingerprint may contain KEY (needs an index built with --keys).
+
+#include "index/ElementIndex.h"
+#include "parser/Parser.h"
+
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+struct Options
+{
+    std::string command;
+    std::string file;
+    std::vector<std::string> args;
+    std::string index;
+    bool ndjson = false;
+    bool keys = false;
+    bool check = false;
+};
+
+bool parseArgs(int argc, char **argv, Options &options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--ndjson")
+            options.ndjson = true;
+        else if (arg == "--keys")
+            options.keys = true;
+        else if (arg == "--check")
+            options.check = true;
+        else if (arg == "--index" && i + 1 < argc)
+            options.index = argv[++i];
+        else if (arg.starts_with("--"))
+            return false;
+        else
+            positional.emplace_back(arg);
+    }
+    if (positional.size() < 2)
+        return false;
+    options.command = positional[0];
+    options.file = positional[1];
+    options.args.assign(positional.begin() + 2, positional.end());
+    if (options.index.empty())
+        options.index = options.file + ".idx";
+    return true;
+}
+
+ElementIndex open(const Options &options)
+{
+    ElementIndex index = ElementIndex::load(options.index);
+    if (index.sourceSize() != std::filesystem::file_size(options.file))
+        throw std::runtime_error(options.index + " does not match " + options.file + "; rebuild it");
+    return index;
+}
+
+int run(const Options &options)
+{
+    if (options.command == "build" && options.args.empty())
+    {
+        ElementIndex index = ElementIndexBuilder::build(
+            options.file, options.ndjson ? ElementIndexBuilder::NDJSON : ElementIndexBuilder::ARRAY, options.keys);
+        index.save(options.index);
+        std::cout << index.size() << " elements indexed in " << options.index << '\n';
+        return 0;
+    }
+
+    if (options.command == "get" && (options.args.size() == 1 || options.args.size() == 2))
+    {
+        ElementIndex index = open(options);
+        size_t first = std::stoull(options.args[0]);
+        size_t count = options.args.size() == 2 ? std::stoull(options.args[1]) : 1;
+        std::ifstream in(options.file, std::ios::binary);
+        Parser parser;
+        for (const std::string &element : index.read(in, first, count))
+        {
+            if (options.check)
+                parser.parseValue(element);
+            std::cout << element << '\n';
+        }
+        return 0;
+    }
+
+    if (options.command == "find" && options.args.size() == 1)
+    {
+        ElementIndex index = open(options);
+        if (!index.hasFingerprints())
+            throw std::runtime_error(options.index + " has no key fingerprints; build it with --keys");
+        for (size_t i = 0; i < index.size(); ++i)
+            if (index.mayContain(i, options.args[0]))
+                std::cout << i << '\n';
+        return 0;
+    }
+
+    if (options.command == "info" && options.args.empty())
+    {
+        ElementIndex index = open(options);
+        std::cout << "elements: " << index.size() << '\n'
+                  << "source bytes: " << index.sourceSize() << '\n'
+                  << "fingerprints: " << (index.hasFingerprints() ? "yes" : "no") << '\n';
+        return 0;
+    }
+
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    int status = 2;
+    if (parseArgs(argc, argv, options))
+    {
+        try
+        {
+            status = run(options);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << argv[0] << ": " << e.what() << '\n';
+            return 1;
+        }
+    }
+    if (status == 2)
+        std::cerr << "usage: " << argv[0] << " build FILE [--ndjson] [--keys] [--index SIDECAR]\n"
+                  << "       " << argv[0] << " get FILE FIRST [COUNT] [--index SIDECAR] [--check]\n"
+                  << "       " << argv[0] << " find FILE KEY [--index SIDECAR]\n"
+                  << "       " << argv[0] << " info FILE [--index SIDECAR]\n";
+    return status;
+}